@@ -15,6 +15,7 @@ extern int insertBlocked (int *semAdd, pcb_PTR p);
 extern pcb_PTR removeBlocked (int *semAdd);
 extern pcb_PTR outBlocked (pcb_PTR p);
 extern pcb_PTR headBlocked (int *semAdd);
+extern pcb_PTR removeAllBlocked (int *semAdd);
 extern void initASL ();
 
 /***************************************************************/
@@ -11,6 +11,12 @@
 #define PAGESIZE	        4096	    /* page size in bytes */
 #define WORDLEN		        4		    /* word size in bytes */
 #define MAXPROC             20
+#define SEMDHASHSIZE        64          /* Number of ASL hash buckets (must be a power of two) */
+#define SEMDHASHSHIFT       2           /* Semaphores are word-aligned: drop the low 2 address bits before hashing */
+#define MAXPIDS             65536       /* Upper bound on PID table slots; the table itself grows a frame at a time */
+#define PIDSLOTBITS         16          /* A PID is (generation << PIDSLOTBITS) | slot */
+#define PIDSLOTMASK         0x0000FFFF  /* Extracts the PID table slot from a PID */
+#define PIDGENMASK          0x00007FFF  /* Generations wrap within 15 bits so PIDs stay positive */
 #define	MAXINT              214483647	/* 2^31 - 1: maximum value of a signed 32-bit integer */
 
 /* Maximum number of external (sub)devices in UMPS3, plus one additional semaphore to support
@@ -108,6 +114,22 @@ This constant is subtracted from the line number (or 4, in the case of backing s
 
 /* Value that the processor's Local Timer (PLT) is intialized to 5 milliseconds (5,000 microseconds) */
 #define INITIALPLT		    5000
+/* Quantum bounds and initial burst are in microseconds; phase5 scales them to TOD ticks once, in initReadyQueues() */
+#define QUANTUMMIN          1000        /* Shortest quantum (1 ms) loaded on the PLT */
+#define QUANTUMMAX          20000       /* Longest quantum (20 ms) loaded on the PLT */
+#define QUANTUMSHIFT        1           /* A process's quantum is its average CPU burst << QUANTUMSHIFT, within [QUANTUMMIN, QUANTUMMAX] */
+#define INITIALBURST        (INITIALPLT >> QUANTUMSHIFT) /* Average CPU burst (microseconds) a new process starts with, so its first quantum is INITIALPLT */
+#define STRIDE1             0x00010000  /* Stride of a process holding a single ticket */
+#define MAXTICKETS          1000        /* Most tickets (CPU shares) a process may hold; at least 1 */
+#define DEFAULTTICKETS      100         /* Tickets held by the first process; children inherit their parent's */
+#define STRIDETIMESHIFT     6           /* CPU time is charged to a process's pass in units of 64 TOD ticks */
+#define EDFMINPERIOD        1000        /* Shortest EDF period (1 ms) */
+#define EDFMAXPERIOD        2000000     /* Longest EDF period (2 s); keeps budget * EDFUTILSCALE within an int */
+#define EDFUTILSCALE        1024        /* EDF utilization (budget / period) is kept in 1/1024ths */
+#define EDFMAXUTIL          921         /* Admission limit on total EDF utilization (90%), leaving room for the nucleus and MLFQ processes */
+#define MLFQLEVELS          4           /* Number of MLFQ Ready Queue levels (at most 4, see firstLevel in scheduler.c) */
+#define MLFQTOP             0           /* Highest-priority MLFQ level: new, I/O-woken and boosted processes */
+#define MLFQBOOSTINTERVAL   1000000     /* Microseconds (1 s) between boosts of every process to MLFQTOP; scaled to TOD ticks in initReadyQueues() */
 
 #define INITIALACCTIME	    0           /* initial value for the accumulated time field for a process that is instantiated */
 /* Constants for returning values in v0 to the caller */
@@ -140,6 +162,35 @@ This constant is subtracted from the line number (or 4, in the case of backing s
 #define	FLASH_GET		16
 #define FLASH_PUT		17 
 #define DELAY               18      
+#define GETPID              21          /* Nucleus: return the caller's PID (user-mode requests are forwarded by the Support Level) */
+#define SETSHARES           22          /* Nucleus: set a process's CPU tickets (user-mode requests are forwarded for the caller only) */
+#define SETPERIOD           23          /* Nucleus: join the EDF class with a period and a budget */
+#define WAITPERIOD          24          /* Nucleus: EDF job done, sleep until the next release */
+#define GETINTSTATS         25          /* Nucleus: copy out one interrupt line's or one device's statistics */
+
+/* Constants for the interrupt statistics (SYS25) */
+#define INTSTATLINE         0           /* a1: a2 is an interrupt line (1-7) */
+#define INTSTATDEVICE       1           /* a1: a2 is a device semaphore index (0..MAXDEVICECNT-1) */
+#define INTLINECNT          8           /* interrupt lines, indexed by line number */
+
+/* Constants for the SYSCALL profile (see sysProfile.c) */
+#define SYSPROFCNT          (GETINTSTATS + 1) /* profiles, indexed by SYSCALL number */
+#define SYSPROFBUCKETS      24          /* log2 latency buckets per SYSCALL */
+#define SYSPROFPRINTER      (DEVPERINT - 1) /* printer the profile is dumped to at HALT (also U-proc UPROCMAX's SYS11 printer) */
+
+/* Constants for the kernel flight recorder (see trace.c and host/ktrace.c) */
+#define TRACESIZE           512         /* events kept in the ring; a power of two */
+#define TRACEMAGIC          0x4B545243  /* "KTRC": marks the ring in a memory dump */
+#define TRDISPATCH          1           /* pid given the CPU */
+#define TRBLOCK             2           /* pid blocked; arg: semaphore address */
+#define TRUNBLOCK           3           /* pid unblocked; arg: semaphore address */
+#define TRSYSENTER          4           /* pid entered the Nucleus by SYSCALL; arg: SYSCALL number */
+#define TRSYSEXIT           5           /* pid resumed from a fast-path SYSCALL; arg: SYSCALL number */
+#define TRINTLINE           6           /* timer interrupt handled; arg: interrupt line (1 or 2) */
+#define TRINTDEV            7           /* device interrupt handled; arg: devSemaphore index */
+#define TRPAGEFAULT         8           /* pid took a page fault; arg: missing page number */
+#define TRIDLE              9           /* the processor entered the Wait State */
+#define TRSOFTFAULT         10          /* pid re-referenced a resident page (clock reference bit); arg: page number */
 
 #define PRINTERROR          4           /* Printer Device Status Code: Error during character transmission */
 #define PRINTCHR            2           /* Printer Device Command Code: Transmit the character in DATA0 over the line */
@@ -218,6 +269,7 @@ This constant is subtracted from the line number (or 4, in the case of backing s
 
 /* Constants for the TLB exception handling */
 #define VALIDOFFTLB         0xFFFFFDFF /* Mask to clear the VALID bit in the EntryLO field of a TLB entry */
+#define PFNMASK             0xFFFFF000 /* Mask to extract the frame address from the EntryLO field of a TLB entry */
 #define WRITEBLK            3          /* Copy the 4 KB of RAM starting at the address in DATA0 into the block located at (BLOCKNUMBER)*/
 #define FLASCOMHSHIFT       8          /* Shift to get the block number from the command sent to the flash device */
 #define WRITEERR            5          /* Flash device status code for write error */
@@ -234,7 +286,12 @@ This constant is subtracted from the line number (or 4, in the case of backing s
 #define MAXSTRINGLEN        128        /* Maximum length of a string that can be passed to devices*/
 #define DEVREDY             1          /* Device is ready for I/O operations */
 #define PERIPHDEVCNT        48         /* Total number of peripheral devices (Disk, Flash, Network, Printer): 4 classes × 8 devices = 32 semaphores and (Terminal devices): 8 terminals × 2 semaphores = 16 semaphores */
-#define	SWAPPOOLADDR	    0x20020000
+#define	SWAPPOOLADDR	    0x20020000 /* First RAM frame above the kernel: the phase3/4 Swap Pool */
+#define SLABSTART           SWAPPOOLADDR /* handed to the slab allocator (the phase5 Swap Pool is carved out of it); main() PANICs if the kernel image reaches past it */
+#define SWAPPOOLMIN         (2 * UPROCMAX) /* Smallest Swap Pool: with less RAM the pager PANICs at boot */
+#define SWAPPOOLMAX         (UPROCMAX * PGTBLSIZE) /* Every page of every U-proc resident */
+#define SLABRESERVE         8          /* Frames left to the slab allocator once the Swap Pool is carved out */
+#define STCKFRAMES          2          /* Frames at the top of RAM used as stacks by test() and the Delay Daemon */
 #define INDEXPMASK          0x80000000 /* Index p for tlb */
 #define RECCHARSTATSHIFT    8
 #define RECCHARSTATMASK     0xFF /* Mask to extract the received character from the terminal device's status field */
@@ -257,7 +314,22 @@ This constant is subtracted from the line number (or 4, in the case of backing s
 /* Macro to load the Interval Timer */
 #define LDIT(T)	            ((* ((cpu_t *) INTERVALTMR)) = (T) * (* ((cpu_t *) TIMESCALEADDR))) 
 
+/* Macro to park the Interval Timer (about an hour away) without scaling NEVER by the time scale */
+#define DISARMIT()          ((* ((cpu_t *) INTERVALTMR)) = NEVER)
+
 /* Macro to read the TOD clock */
 #define STCK(T)             ((T) = ((* ((cpu_t *) TODLOADDR)) / (* ((cpu_t *) TIMESCALEADDR))))
 
+/* Macro for the time scale: TOD ticks per microsecond */
+#define TIMESCALE           (* ((cpu_t *) TIMESCALEADDR))
+
+/* Macro to read the TOD clock in raw ticks, with no divide; the Nucleus keeps all of its times this way */
+#define STCKTICKS(T)        ((T) = (* ((cpu_t *) TODLOADDR)))
+
+/* Macro to convert a time in microseconds to TOD ticks */
+#define USTOTICKS(U)        ((U) * TIMESCALE)
+
+/* Macro to load the Interval Timer with a raw tick count */
+#define LDITTICKS(T)        ((* ((cpu_t *) INTERVALTMR)) = (T))
+
 #endif
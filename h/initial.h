@@ -15,7 +15,8 @@
  * Phase 2 Globals (as actually used in initial.c):
  *   - The ‘processCount’ and ‘softBlockedCount’ track active processes.
  *   - ‘currentProcess’ is the PCB of the process currently running.
- *   - ‘readyQueue’ is the tail pointer to the ready queue of PCBs.
+ *   - ‘readyQueue’ is the tail pointer to the ready queue of PCBs (phase2-4;
+ *     phase5 keeps one queue per MLFQ level, see scheduler.h).
  *   - ‘startTOD’ stores the Time of Day at which the Current Process started.
  *   - ‘devSemaphore[]’ holds one semaphore per external device + 1 pseudo-clock.
  *   - ‘savedExceptState’ stores the CPU state at the time of an exception.
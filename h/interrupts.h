@@ -11,9 +11,13 @@
 #include "../h/types.h"
 
 /*
- * The only externally visible function from interrupts.c is intTrapH(),
- * which is the entry point for handling all device/timer interrupts.
+ * intTrapH() is the entry point for handling all device/timer interrupts.
+ * initPseudoClock() and armPseudoClock() run the one-shot pseudo-clock.
+ * getIntStat() copies out the statistics of one line or device (SYS25).
  */
 extern void intTrapH(void);
+extern void initPseudoClock(void);
+extern void armPseudoClock(void);
+extern int getIntStat(int kind, int index, intstat_PTR stat);
 
 #endif
@@ -14,6 +14,7 @@
 extern void freePcb (pcb_PTR p);
 extern pcb_PTR allocPcb ();
 extern void initPcbs ();
+extern pcb_PTR pidToPcb (int pid);
 
 extern pcb_PTR mkEmptyProcQ ();
 extern int emptyProcQ (pcb_PTR tp);
@@ -21,6 +22,7 @@ extern void insertProcQ (pcb_PTR *tp, pcb_PTR p);
 extern pcb_PTR removeProcQ (pcb_PTR *tp);
 extern pcb_PTR outProcQ (pcb_PTR *tp, pcb_PTR p);
 extern pcb_PTR headProcQ (pcb_PTR tp);
+extern int spliceProcQ (pcb_PTR *tp, pcb_PTR q);
 
 extern int emptyChild (pcb_PTR p);
 extern void insertChild (pcb_PTR prnt, pcb_PTR p);
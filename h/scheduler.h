@@ -13,11 +13,37 @@
 
 /* 
  * The scheduler provides:
- *   - switchProcess(): Preemptive round-robin scheduling.
+ *   - switchProcess(): Preemptive MLFQ scheduling.
+ *   - initReadyQueues(), makeReady(), makeReadyAll(), outReady(): 
+ *     the per-level Ready Queues.
+ *   - demoteProcess(), boostReadyQueues(): MLFQ level changes.
+ *   - endBurst(): feeds a finished CPU burst into the adaptive quantum 
+ *     and the stride pass.
+ *   - setShares(): sets a process's tickets.
+ *   - initSchedFields(): scheduling fields of a new process.
+ *   - joinEdf(), leaveEdf(), endJob(): the EDF class.
+ *   - quantumExpired(), preempts(): PLT expiry and preemption decisions.
  *   - loadProcessorState(): Set currentProc & load state.
  *   - moveState(): Copy CPU state from one area to another.
  */
+extern pcb_PTR readyQueues[MLFQLEVELS];	/* Tail pointers of the MLFQ Ready Queues (phase5) */
+extern unsigned int readyMap;			/* Bit l is on iff readyQueues[l] is not empty */
+
 extern void switchProcess(void);
+extern void initReadyQueues(void);
+extern void makeReady(pcb_PTR p);
+extern int makeReadyAll(pcb_PTR q);
+extern pcb_PTR outReady(pcb_PTR p);
+extern void demoteProcess(pcb_PTR p);
+extern void boostReadyQueues(void);
+extern void endBurst(pcb_PTR p);
+extern void setShares(pcb_PTR p, int tickets);
+extern void initSchedFields(pcb_PTR p, pcb_PTR parent);
+extern int joinEdf(pcb_PTR p, cpu_t period, cpu_t budget, cpu_t now);
+extern void leaveEdf(pcb_PTR p);
+extern void endJob(pcb_PTR p, cpu_t now);
+extern void quantumExpired(pcb_PTR p);
+extern int preempts(pcb_PTR p, pcb_PTR cur);
 extern void loadProcessorState(pcb_PTR curr_proc);
 extern void moveState(state_PTR source, state_PTR dest);
 
@@ -0,0 +1,20 @@
+#ifndef SLAB
+#define SLAB
+
+/**************************************************************************** 
+ *
+ * The externals declaration file for the Slab Allocator module.
+ *
+ * Written by: Luka Bagashvili, Rosalie Lee
+ *
+ ****************************************************************************/
+#include "../h/types.h"
+
+extern void initSlab(memaddr base, memaddr top);
+extern memaddr allocFrame(void);
+extern int framesLeft(void);
+extern void initCache(slabcache_t *cache, unsigned int objSize);
+extern void *slabAlloc(slabcache_t *cache);
+extern void slabFree(slabcache_t *cache, void *obj);
+
+#endif
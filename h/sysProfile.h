@@ -0,0 +1,19 @@
+#ifndef SYSPROFILE
+#define SYSPROFILE
+
+/**************************************************************************** 
+ *
+ * Declaration header for the SYSCALL profile.
+ *
+ * profileSys() records one completed request; dumpSysProfile() prints 
+ * the profile on printer SYSPROFPRINTER.
+ *
+ * Written by: Luka Bagashvili, Rosalie Lee
+ *
+ ****************************************************************************/
+#include "../h/types.h"
+
+extern void profileSys(int sysNum, cpu_t ticks);
+extern void dumpSysProfile(void);
+
+#endif
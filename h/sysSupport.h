@@ -9,4 +9,7 @@ extern void schizoUserProcTerminate(int *address);
 /* Support-level general exception handler */
 extern void supLvlGenExceptionHandler(void);
 
+/* Return to the U-proc from a SYS9+ request, recording it in the SYSCALL profile */
+extern void returnToUProc(support_t *sPtr);
+
 #endif /* SYSSUPPORT_H */
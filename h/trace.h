@@ -0,0 +1,26 @@
+#ifndef TRACE
+#define TRACE
+
+/**************************************************************************** 
+ *
+ * Declaration header for the kernel flight recorder.
+ *
+ * TRACEINIT() and TRACEEVENT() are the only entry points; without KTRACE 
+ * defined (make KTRACE=1) both compile to nothing.
+ *
+ * Written by: Luka Bagashvili, Rosalie Lee
+ *
+ ****************************************************************************/
+#include "../h/types.h"
+
+#ifdef KTRACE
+extern void traceInit(void);
+extern void traceEvent(unsigned int type, int pid, unsigned int arg);
+#define TRACEINIT()             traceInit()
+#define TRACEEVENT(T, P, A)     traceEvent((T), (P), (unsigned int) (A))
+#else
+#define TRACEINIT()
+#define TRACEEVENT(T, P, A)
+#endif
+
+#endif
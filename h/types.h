@@ -98,6 +98,7 @@ typedef struct support_t {
 	int				sup_stackTLB[500];		/* the stack area for the process' TLB exception handler, an integer array of 500 is a 2Kb area. */
 	int				sup_stackGen[500];		/* the stack area for the process' general exception handler */
 	int             sup_delaySem;           /* private semaphore for SYS18 */
+	cpu_t			sup_sysStart;			/* TOD (raw ticks) at which the current SYS9+ request entered */
 } support_t;
 
 /* Delay structure type */
@@ -107,11 +108,68 @@ typedef struct delayd_t {
 	support_t 		*d_supStruct; 	/* pointer to a Support Structure, denoting the sleeping U-proc’s identity */
 } delayd_t;
 
-/* process control block type */
+/* Interrupt statistics type: one per interrupt line and one per device semaphore */
+typedef struct intstat_t {
+	unsigned int	is_count;		/* interrupts handled */
+	cpu_t			is_time;		/* cumulative handler time, in TOD ticks */
+	cpu_t			is_maxLatency;	/* longest time from kernel entry to the end of the handler, in TOD ticks */
+} intstat_t, *intstat_PTR;
+
+/* SYSCALL profile type: one per SYSCALL number */
+typedef struct sysprof_t {
+	unsigned int	sp_count;					/* requests completed */
+	cpu_t			sp_time;					/* cumulative latency, in TOD ticks */
+	unsigned int	sp_hist[SYSPROFBUCKETS];	/* sp_hist[k]: latencies below 2^(k+1) ticks (the last: all the rest) */
+} sysprof_t;
+
+/* Flight recorder event type (see trace.c) */
+typedef struct traceev_t {
+	cpu_t			te_time;		/* TOD, in raw ticks */
+	unsigned int	te_type;		/* TRDISPATCH .. TRSOFTFAULT */
+	int				te_pid;			/* process the event is about (0: none) */
+	unsigned int	te_arg;			/* event-specific argument */
+} traceev_t;
+
+/* Flight recorder ring type: laid out so a RAM image can be searched for it */
+typedef struct tracebuf_t {
+	unsigned int	tb_magic;		/* TRACEMAGIC */
+	unsigned int	tb_check;		/* ~TRACEMAGIC */
+	unsigned int	tb_size;		/* TRACESIZE */
+	unsigned int	tb_scale;		/* TOD ticks per microsecond */
+	unsigned int	tb_next;		/* events ever recorded; the next goes in tb_ev[tb_next % TRACESIZE] */
+	traceev_t		tb_ev[TRACESIZE];
+} tracebuf_t;
+
+/* Object cache type: a free list of equally-sized objects carved out of RAM frames */
+typedef struct slabcache_t {
+	void			*c_free;		/* head of the free object list */
+	unsigned int	c_objSize;		/* size of each object in bytes (word-aligned) */
+	int				c_frames;		/* number of frames the cache has grown by */
+} slabcache_t;
+
+/* PID table entry type: one slot of the table that maps PIDs to PCBs */
+typedef struct pidslot_t {
+	struct pcb_t	*ps_pcb;		/* owning PCB, or NULL if the slot is free */
+	int				ps_gen;			/* current generation of the slot */
+	int				ps_nextFree;	/* next slot on the free list (0 ends it) */
+} pidslot_t;
+
+/* process control block type
+ *
+ * The fields touched by every queue operation, ASL lookup and CPU-time 
+ * update come first, so they share the start of the PCB; the MLFQ, stride 
+ * and EDF fields, read once per dispatch, follow the tree and support 
+ * fields, and the 140-byte processor state, only read or written on a 
+ * context switch, sits at the end where it does not dilute them. */
 typedef struct pcb_t {
     /* Process queue fields */
     struct pcb_t *p_next;    /* Pointer to next entry on queue    */
     struct pcb_t *p_prev;    /* Pointer to previous entry on queue*/
+    struct pcb_t **p_queue;  /* Tail pointer of the queue p is on (NULL if on none) */
+
+    /* Semaphore on which proc might be blocked, and CPU time */
+    int     *p_semAdd;       /* Pointer to semaphore    */
+    cpu_t   p_time;          /* CPU time used by proc, in TOD ticks */
 
     /* Process tree fields */
     struct pcb_t *p_prnt;    /* Pointer to parent PCB   */
@@ -119,13 +177,29 @@ typedef struct pcb_t {
     struct pcb_t *p_next_sib;/* Pointer to next sibling */
 	struct pcb_t *p_prev_sib;/* Pointer to previous sibling */
 
-    /* Processor state, CPU time, and semaphore on which proc might be blocked */
-    state_t p_s;             /* Processor state         */
-    cpu_t   p_time;          /* CPU time used by proc   */
-    int     *p_semAdd;       /* Pointer to semaphore    */
-
     /* Pointer to any support structure (used in later phases)  */
     support_t *p_supportStruct;
+    int     p_pid;           /* PID: PID table slot plus generation */
+    int     p_tickets;       /* CPU shares (1..MAXTICKETS) */
+    int     p_missed;        /* EDF deadlines missed so far */
+    int     p_sysNum;        /* SYSCALL the process is blocked in (0: none), profiled when it resumes */
+    cpu_t   p_sysStart;      /* TOD (raw ticks) at which that SYSCALL entered */
+
+    /* Scheduling fields (read on dispatch and at the end of a burst, not by queue operations) */
+    int     p_level;         /* MLFQ level (0 = highest priority) */
+    cpu_t   p_sliceStart;    /* p_time when last dispatched */
+    cpu_t   p_burst;         /* Running average of CPU time used per dispatch */
+    unsigned int p_pass;     /* Stride scheduling: virtual time consumed */
+    unsigned int p_stride;   /* Stride scheduling: STRIDE1 / p_tickets */
+    cpu_t   p_period;        /* EDF period in TOD ticks (0 if not in the EDF class) */
+    cpu_t   p_budget;        /* EDF CPU budget per period, in TOD ticks */
+    cpu_t   p_remaining;     /* EDF budget left in the current period */
+    cpu_t   p_deadline;      /* EDF absolute deadline (TOD) of the current job, also its next release */
+    int     p_util;          /* EDF utilization, in 1/EDFUTILSCALE */
+    int     p_jobDone;       /* EDF: TRUE if sleeping because the job finished, FALSE if throttled */
+
+    /* Processor state (cold: only used when the process is dispatched or stopped) */
+    state_t p_s;             /* Processor state         */
 } pcb_t, *pcb_PTR;
 
 
@@ -140,6 +214,8 @@ typedef struct swap_t {
 	int asid;          /* ASID of the process that owns this swap entry */
 	int VPN;    /* Page number of the entry */
 	pte_entry_t *pte; /* Pointer to the page table entry associated with this swap entry */
+	int next;          /* next free frame (-1: none), while this one is free */
+	int busy;          /* ASID of the U-proc doing flash I/O on this frame, 0 if none */
 } swap_t;
 
 
@@ -3,9 +3,15 @@
 
 #include "types.h"
 
+/* Mutual exclusion over the Swap Pool */
+extern int swapPoolSemaphore;
+
 /* Initialize swap pool structures and semaphore */
 extern void initSwapStructs();
 
+/* Return a terminating U-proc's frames to the free list (swapPoolSemaphore held) */
+extern void releaseFrames(int asid);
+
 /* Acquire or release mutex on a semaphore */
 extern void mutex(int *sem, int operation); /* operation TRUE (P) or FALSE (V) */
 
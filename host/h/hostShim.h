@@ -0,0 +1,29 @@
+#ifndef HOSTSHIM
+#define HOSTSHIM
+
+/**************************************************************************** 
+ *
+ * Shim that lets the Pandos headers and Phase 1 modules be compiled on the 
+ * host (x86-64 Linux) for benchmarking.
+ *
+ *   - Pulls in the C library first, then drops its NULL so ../h/const.h can 
+ *     define the Pandos NULL. Compare libc results against (void *) 0.
+ *   - Declares the timing and randomization helpers in hostShim.c.
+ *
+ * Written by: Luka Bagashvili, Rosalie Lee
+ *
+ ****************************************************************************/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#undef NULL
+
+#include "../../h/const.h"
+
+extern double hostNow(void);
+extern unsigned int hostRand(void);
+extern void hostSeed(unsigned int seed);
+extern void hostShuffle(int *order, int n, unsigned int seed);
+
+#endif
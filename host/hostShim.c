@@ -0,0 +1,54 @@
+/******************************** hostShim.c **********************************
+ *
+ * Timing and pseudo-random helpers for the host-side benchmarks.
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "h/hostShim.h"
+
+HIDDEN unsigned int randState = 1;  /* xorshift32 state; never zero */
+
+/************************************************************************
+ * hostNow - Returns a monotonic timestamp in nanoseconds.
+ ************************************************************************/
+double hostNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/************************************************************************
+ * hostSeed/hostRand - Deterministic xorshift32 generator, so a failing 
+ *                     workload can be replayed from its seed.
+ ************************************************************************/
+void hostSeed(unsigned int seed) {
+    randState = (seed != 0) ? seed : 1;
+}
+
+unsigned int hostRand() {
+    randState ^= randState << 13;
+    randState ^= randState >> 17;
+    randState ^= randState << 5;
+    return randState;
+}
+
+/************************************************************************
+ * hostShuffle - Fills order[0..n-1] with a random permutation of 0..n-1.
+ ************************************************************************/
+void hostShuffle(int *order, int n, unsigned int seed) {
+    int i, j, tmp;
+
+    hostSeed(seed);
+    for (i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    for (i = n - 1; i > 0; i--) {
+        j = hostRand() % (i + 1);
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+}
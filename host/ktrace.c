@@ -0,0 +1,161 @@
+/******************************** ktrace.c **********************************
+ *
+ * Host-side (x86-64 Linux) decoder for the kernel flight recorder (see
+ * ../phase5/trace.c, built with make KTRACE=1).
+ *
+ * Reads a raw image of uMPS3 RAM (little-endian, as saved from the
+ * emulator), finds the ring by its TRACEMAGIC/~TRACEMAGIC header, and
+ * writes its events, oldest first, to stdout as Chrome trace JSON (load
+ * it in chrome://tracing or https://ui.perfetto.dev):
+ *   - thread "CPU": one slice per stretch a process held the processor,
+ *     from its dispatch until the next dispatch, block or Wait State;
+ *   - thread "interrupts": an instant per timer or device interrupt;
+ *   - one thread per PID: instants for SYSCALL entry and fast-path return,
+ *     block, unblock, page fault and soft (reference bit) fault.
+ * Times are microseconds since the oldest event kept in the ring.
+ *
+ * Usage: make ktrace && ./ktrace ramImage > trace.json
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#include "h/hostShim.h"
+#include "../h/types.h"
+
+#define CPUTID          0           /* Chrome thread of the processor timeline */
+#define INTTID          1           /* Chrome thread of the interrupts */
+
+HIDDEN const char *sep = "";    /* separator before the next JSON event */
+
+/* Finds the ring in image (len bytes); returns NULL if there is none */
+HIDDEN tracebuf_t *findRing(unsigned char *image, long len) {
+	long off;
+	tracebuf_t *ring;
+
+	for (off = 0; off + (long) sizeof(tracebuf_t) <= len; off += WORDLEN) {
+		ring = (tracebuf_t *) (image + off);
+		if (ring->tb_magic == TRACEMAGIC && ring->tb_check == (unsigned int) ~TRACEMAGIC &&
+		    ring->tb_size == TRACESIZE && ring->tb_scale != 0) {
+			return ring;
+		}
+	}
+	return (tracebuf_t *) 0;
+}
+
+HIDDEN void instant(double ts, int tid, const char *name, unsigned int arg) {
+	printf("%s\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"arg\":\"0x%x\"}}",
+	       sep, name, tid, ts, arg);
+	sep = ",";
+}
+
+HIDDEN void slice(double ts, double end, int pid) {
+	printf("%s\n{\"name\":\"pid %d\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+	       sep, pid, CPUTID, ts, end - ts);
+	sep = ",";
+}
+
+HIDDEN void threadName(int tid, const char *name) {
+	printf("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+	       sep, tid, name);
+	sep = ",";
+}
+
+int main(int argc, char *argv[]) {
+	FILE *f;
+	unsigned char *image;
+	long len;
+	tracebuf_t *ring;
+	traceev_t *ev;
+	unsigned int first, i;
+	cpu_t base;
+	double ts, runStart = 0;
+	int running = 0;            /* PID holding the CPU, 0 if none */
+	char name[32];
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s ramImage > trace.json\n", argv[0]);
+		return 1;
+	}
+	if ((f = fopen(argv[1], "rb")) == (void *) 0) {
+		perror(argv[1]);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	rewind(f);
+	image = malloc(len);
+	if (image == (void *) 0 || fread(image, 1, len, f) != (size_t) len) {
+		fprintf(stderr, "%s: cannot read the image\n", argv[1]);
+		return 1;
+	}
+	fclose(f);
+
+	if ((ring = findRing(image, len)) == (void *) 0) {
+		fprintf(stderr, "%s: no flight recorder ring (was the kernel built with KTRACE=1?)\n", argv[1]);
+		return 1;
+	}
+
+	first = (ring->tb_next > TRACESIZE) ? ring->tb_next - TRACESIZE : 0;
+	base = ring->tb_ev[first & (TRACESIZE - 1)].te_time;
+	fprintf(stderr, "ktrace: %u events recorded, decoding the last %u\n", ring->tb_next, ring->tb_next - first);
+
+	printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	threadName(CPUTID, "CPU");
+	threadName(INTTID, "interrupts");
+
+	for (i = first; i < ring->tb_next; i++) {
+		ev = &ring->tb_ev[i & (TRACESIZE - 1)];
+		ts = (double) (unsigned int) (ev->te_time - base) / ring->tb_scale;
+
+		/* the processor timeline */
+		if (ev->te_type == TRDISPATCH || ev->te_type == TRIDLE ||
+		    (ev->te_type == TRBLOCK && ev->te_pid == running)) {
+			if (running != 0 && (ev->te_type != TRDISPATCH || ev->te_pid != running)) {
+				slice(runStart, ts, running);
+				running = 0;
+			}
+			if (ev->te_type == TRDISPATCH && running == 0) {
+				running = ev->te_pid;
+				runStart = ts;
+			}
+		}
+
+		switch (ev->te_type) {
+			case TRBLOCK:
+				instant(ts, ev->te_pid, "block", ev->te_arg);
+				break;
+			case TRUNBLOCK:
+				instant(ts, ev->te_pid, "unblock", ev->te_arg);
+				break;
+			case TRSYSENTER:
+				sprintf(name, "SYS%u", ev->te_arg);
+				instant(ts, ev->te_pid, name, ev->te_arg);
+				break;
+			case TRSYSEXIT:
+				sprintf(name, "SYS%u return", ev->te_arg);
+				instant(ts, ev->te_pid, name, ev->te_arg);
+				break;
+			case TRINTLINE:
+				sprintf(name, "line %u", ev->te_arg);
+				instant(ts, INTTID, name, ev->te_arg);
+				break;
+			case TRINTDEV:
+				sprintf(name, "device %u", ev->te_arg);
+				instant(ts, INTTID, name, ev->te_arg);
+				break;
+			case TRPAGEFAULT:
+				instant(ts, ev->te_pid, "page fault", ev->te_arg);
+				break;
+			case TRSOFTFAULT:
+				instant(ts, ev->te_pid, "soft fault", ev->te_arg);
+				break;
+			default:
+				break;
+		}
+	}
+	if (running != 0) {
+		slice(runStart, ts, running);
+	}
+	printf("\n]}\n");
+	return 0;
+}
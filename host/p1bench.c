@@ -0,0 +1,402 @@
+/******************************** p1bench.c **********************************
+ *
+ * Host-side (x86-64 Linux) benchmark and fuzz harness for the Phase 1
+ * modules (pcb.c and asl.c), compiled unmodified from a phase directory.
+ *
+ *   1. Benchmark: each PCB/ASL entry point is driven in bulk with random
+ *      operands (thousands of PCBs spread over thousands of semaphores)
+ *      and its cost is reported in ns/op.
+ *   2. Fuzz: a random mix of insertBlocked/removeBlocked/outBlocked/
+ *      headBlocked and insertProcQ/removeProcQ/outProcQ/headProcQ (plus
+ *      removeAllBlocked+spliceProcQ, in phases that have them) is run
+ *      against a shadow model of every queue; the first divergence is
+ *      reported together with the seed that reproduces it.
+ *
+ * Phases whose PCBs come from the slab allocator get a MAP_32BIT region
+ * as their "RAM" (the modules keep addresses in 32-bit memaddr values).
+ * Phases with static tables stop at MAXPROC PCBs.
+ *
+ * Usage: ./p1bench-<phase> [pcbs] [semaphores] [fuzz ops] [seed]
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#include "h/hostShim.h"
+#include "../h/types.h"
+#include "../h/pcb.h"
+#include "../h/asl.h"
+#ifdef HOSTSLAB
+#include "../h/slab.h"
+#endif
+
+#define DEFAULTPCBS     4096
+#define DEFAULTSEMS     4096
+#define DEFAULTOPS      1000000
+#define DEFAULTSEED     1
+#define BENCHREPS       16          /* repetitions of each timed pass */
+#define HOSTRAMSIZE     (64 * 1024 * 1024)
+#define NOWHERE         (-1)        /* shadow: PCB is on no queue */
+#define ONREADY         (-2)        /* shadow: PCB is on the ready queue */
+#ifdef HOSTSPLICE
+#define FUZZCASES       9           /* fuzz also drives removeAllBlocked+spliceProcQ */
+#else
+#define FUZZCASES       8
+#endif
+
+HIDDEN pcb_PTR *pcbs;       /* every PCB the harness could allocate */
+HIDDEN int     *sems;       /* the semaphores PCBs block on */
+HIDDEN int     *operand;    /* pre-drawn random operands for the timed passes */
+HIDDEN int     pcbCnt, semCnt;
+
+/* Shadow model: one FIFO per semaphore plus one for the ready queue, kept as index rings */
+HIDDEN int *where;          /* semaphore index, ONREADY or NOWHERE */
+HIDDEN int *shNext, *shPrev;
+HIDDEN int *shTail;         /* tail index of each semaphore FIFO (NOWHERE if empty) */
+HIDDEN int readyTail;
+
+HIDDEN pcb_PTR readyQueue;
+
+
+/************************************************************************
+ * Shadow model helpers
+ ************************************************************************/
+HIDDEN void shInsert(int *tail, int i) {
+    if (*tail == NOWHERE) {
+        shNext[i] = shPrev[i] = i;
+    } else {
+        shNext[i] = shNext[*tail];
+        shPrev[i] = *tail;
+        shPrev[shNext[*tail]] = i;
+        shNext[*tail] = i;
+    }
+    *tail = i;
+}
+
+HIDDEN void shOut(int *tail, int i) {
+    if (shNext[i] == i) {
+        *tail = NOWHERE;
+    } else {
+        shNext[shPrev[i]] = shNext[i];
+        shPrev[shNext[i]] = shPrev[i];
+        if (*tail == i) {
+            *tail = shPrev[i];
+        }
+    }
+    where[i] = NOWHERE;
+}
+
+HIDDEN int shHead(int tail) {
+    return (tail == NOWHERE) ? NOWHERE : shNext[tail];
+}
+
+HIDDEN int cmpPcb(const void *a, const void *b) {
+    pcb_PTR x = *(const pcb_PTR *) a, y = *(const pcb_PTR *) b;
+    return (x < y) ? -1 : (x > y);
+}
+
+
+/************************************************************************
+ * setup - Initializes the modules and allocates up to wanted PCBs,
+ *         keeping them sorted by address.
+ ************************************************************************/
+HIDDEN void setup(int wanted) {
+#ifdef HOSTSLAB
+    static void *ram = (void *) 0;
+
+    if (ram == (void *) 0) {
+        ram = mmap((void *) 0, HOSTRAMSIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+        if (ram == MAP_FAILED) {
+            perror("mmap");
+            exit(1);
+        }
+    }
+    initSlab((memaddr) (unsigned long) ram, (memaddr) (unsigned long) ram + HOSTRAMSIZE);
+#endif
+    initPcbs();
+    initASL();
+    readyQueue = mkEmptyProcQ();
+
+    for (pcbCnt = 0; pcbCnt < wanted; pcbCnt++) {
+        if ((pcbs[pcbCnt] = allocPcb()) == NULL) {
+            break;
+        }
+    }
+    qsort(pcbs, pcbCnt, sizeof(pcb_PTR), cmpPcb);
+}
+
+HIDDEN void drawOperands(int n, int range) {
+    int i;
+    for (i = 0; i < n; i++) {
+        operand[i] = hostRand() % range;
+    }
+}
+
+HIDDEN void report(const char *name, double ns, long ops) {
+    printf("  %-14s %9.1f ns/op\n", name, ns / (double) ops);
+}
+
+
+/************************************************************************
+ * bench - Times each entry point over BENCHREPS passes.
+ *
+ *   Every pass blocks all PCBs on random semaphores, probes random
+ *   semaphores with headBlocked, pulls a random half out with outBlocked
+ *   and drains the rest with removeBlocked; then it repeats the pattern on
+ *   the ready queue with insertProcQ/headProcQ/outProcQ/removeProcQ.
+ ************************************************************************/
+HIDDEN void bench() {
+    double t[8], t0;
+    long semRemoves = 0, rdyRemoves = 0;   /* removeBlocked/removeProcQ calls, including the final NULL-returning ones */
+    int i, r;
+    pcb_PTR p;
+
+    for (i = 0; i < 8; i++) {
+        t[i] = 0;
+    }
+    for (r = 0; r < BENCHREPS; r++) {
+        drawOperands(pcbCnt, semCnt);
+        t0 = hostNow();
+        for (i = 0; i < pcbCnt; i++) {
+            insertBlocked(&sems[operand[i]], pcbs[i]);
+        }
+        t[0] += hostNow() - t0;
+
+        t0 = hostNow();
+        for (i = 0; i < pcbCnt; i++) {
+            p = headBlocked(&sems[operand[i]]);
+        }
+        t[1] += hostNow() - t0;
+
+        drawOperands(pcbCnt, pcbCnt);
+        t0 = hostNow();
+        for (i = 0; i < pcbCnt / 2; i++) {
+            outBlocked(pcbs[operand[i]]);
+        }
+        t[2] += hostNow() - t0;
+
+        t0 = hostNow();
+        for (i = 0; i < semCnt; i++) {
+            do {
+                semRemoves++;
+            } while (removeBlocked(&sems[i]) != NULL);
+        }
+        t[3] += hostNow() - t0;
+
+        t0 = hostNow();
+        for (i = 0; i < pcbCnt; i++) {
+            pcbs[i]->p_semAdd = NULL;
+            insertProcQ(&readyQueue, pcbs[i]);
+        }
+        t[4] += hostNow() - t0;
+
+        t0 = hostNow();
+        for (i = 0; i < pcbCnt; i++) {
+            p = headProcQ(readyQueue);
+        }
+        t[5] += hostNow() - t0;
+
+        t0 = hostNow();
+        for (i = 0; i < pcbCnt / 2; i++) {
+            outProcQ(&readyQueue, pcbs[operand[i]]);
+        }
+        t[6] += hostNow() - t0;
+
+        t0 = hostNow();
+        do {
+            rdyRemoves++;
+        } while (removeProcQ(&readyQueue) != NULL);
+        t[7] += hostNow() - t0;
+    }
+    (void) p;
+
+    printf("bench: %d PCBs, %d semaphores, %d passes\n", pcbCnt, semCnt, BENCHREPS);
+    report("insertBlocked", t[0], (long) pcbCnt * BENCHREPS);
+    report("headBlocked", t[1], (long) pcbCnt * BENCHREPS);
+    report("outBlocked", t[2], (long) (pcbCnt / 2) * BENCHREPS);
+    report("removeBlocked", t[3], semRemoves);
+    report("insertProcQ", t[4], (long) pcbCnt * BENCHREPS);
+    report("headProcQ", t[5], (long) pcbCnt * BENCHREPS);
+    report("outProcQ", t[6], (long) (pcbCnt / 2) * BENCHREPS);
+    report("removeProcQ", t[7], rdyRemoves);
+}
+
+
+/************************************************************************
+ * fuzz - Runs ops random calls against the shadow model.
+ *        Returns the number of the first failing op, or 0 on success.
+ ************************************************************************/
+HIDDEN long fuzz(long ops) {
+    long n;
+    int i, s, got;
+    pcb_PTR p;
+#ifdef HOSTSPLICE
+    int k, moved;
+#endif
+
+    for (i = 0; i < pcbCnt; i++) {
+        where[i] = NOWHERE;
+    }
+    for (s = 0; s < semCnt; s++) {
+        shTail[s] = NOWHERE;
+    }
+    readyTail = NOWHERE;
+
+    for (n = 1; n <= ops; n++) {
+        i = hostRand() % pcbCnt;
+        s = hostRand() % semCnt;
+
+        switch (hostRand() % FUZZCASES) {
+            case 0:     /* insertBlocked */
+                if (where[i] != NOWHERE) {
+                    break;
+                }
+                if (insertBlocked(&sems[s], pcbs[i]) != FALSE || pcbs[i]->p_semAdd != &sems[s]) {
+                    return n;
+                }
+                where[i] = s;
+                shInsert(&shTail[s], i);
+                break;
+
+            case 1:     /* removeBlocked */
+                got = shHead(shTail[s]);
+                p = removeBlocked(&sems[s]);
+                if ((got == NOWHERE) ? (p != NULL) : (p != pcbs[got] || p->p_semAdd != NULL)) {
+                    return n;
+                }
+                if (got != NOWHERE) {
+                    shOut(&shTail[s], got);
+                }
+                break;
+
+            case 2:     /* outBlocked */
+                p = outBlocked(pcbs[i]);
+                if (where[i] >= 0) {
+                    if (p != pcbs[i]) {
+                        return n;
+                    }
+                    shOut(&shTail[where[i]], i);
+                    pcbs[i]->p_semAdd = NULL;
+                } else if (p != NULL) {
+                    return n;
+                }
+                break;
+
+            case 3:     /* headBlocked */
+                got = shHead(shTail[s]);
+                p = headBlocked(&sems[s]);
+                if (p != ((got == NOWHERE) ? NULL : pcbs[got])) {
+                    return n;
+                }
+                break;
+
+            case 4:     /* insertProcQ */
+                if (where[i] != NOWHERE) {
+                    break;
+                }
+                insertProcQ(&readyQueue, pcbs[i]);
+                where[i] = ONREADY;
+                shInsert(&readyTail, i);
+                break;
+
+            case 5:     /* removeProcQ */
+                got = shHead(readyTail);
+                p = removeProcQ(&readyQueue);
+                if (p != ((got == NOWHERE) ? NULL : pcbs[got])) {
+                    return n;
+                }
+                if (got != NOWHERE) {
+                    shOut(&readyTail, got);
+                }
+                break;
+
+            case 6:     /* outProcQ: must refuse PCBs that are not on the ready queue */
+                p = outProcQ(&readyQueue, pcbs[i]);
+                if (p != ((where[i] == ONREADY) ? pcbs[i] : NULL)) {
+                    return n;
+                }
+                if (where[i] == ONREADY) {
+                    shOut(&readyTail, i);
+                }
+                break;
+
+            case 7:     /* headProcQ */
+                got = shHead(readyTail);
+                if (headProcQ(readyQueue) != ((got == NOWHERE) ? NULL : pcbs[got])) {
+                    return n;
+                }
+                break;
+
+#ifdef HOSTSPLICE
+            default:    /* removeAllBlocked+spliceProcQ: the whole FIFO moves to the ready queue in order */
+                p = removeAllBlocked(&sems[s]);
+                moved = spliceProcQ(&readyQueue, p);
+                if (shTail[s] == NOWHERE) {
+                    if (p != NULL || moved != 0) {
+                        return n;
+                    }
+                    break;
+                }
+                /* walk back from the new ready tail over the spliced PCBs */
+                k = shTail[s];
+                got = 0;
+                do {
+                    if (p != pcbs[k] || p->p_semAdd != NULL || p->p_queue != &readyQueue) {
+                        return n;
+                    }
+                    p = p->p_prev;
+                    k = shPrev[k];
+                    got++;
+                } while (k != shTail[s]);
+                if (readyQueue != pcbs[shTail[s]] || moved != got) {
+                    return n;
+                }
+                while ((k = shHead(shTail[s])) != NOWHERE) {
+                    shOut(&shTail[s], k);
+                    where[k] = ONREADY;
+                    shInsert(&readyTail, k);
+                }
+                break;
+#endif
+        }
+    }
+    return 0;
+}
+
+
+int main(int argc, char **argv) {
+    int wanted = (argc > 1) ? atoi(argv[1]) : DEFAULTPCBS;
+    long ops = (argc > 3) ? atol(argv[3]) : DEFAULTOPS;
+    unsigned int seed = (argc > 4) ? (unsigned int) atol(argv[4]) : DEFAULTSEED;
+    long failed;
+
+    semCnt = (argc > 2) ? atoi(argv[2]) : DEFAULTSEMS;
+    if (wanted < 1 || semCnt < 1) {
+        fprintf(stderr, "usage: %s [pcbs] [semaphores] [fuzz ops] [seed]\n", argv[0]);
+        return 1;
+    }
+    pcbs = calloc(wanted, sizeof(pcb_PTR));
+    sems = calloc(semCnt, sizeof(int));
+    operand = calloc(wanted > semCnt ? wanted : semCnt, sizeof(int));
+    where = calloc(wanted, sizeof(int));
+    shNext = calloc(wanted, sizeof(int));
+    shPrev = calloc(wanted, sizeof(int));
+    shTail = calloc(semCnt, sizeof(int));
+
+    hostSeed(seed);
+    setup(wanted);
+    if (pcbCnt < wanted) {
+        printf("note: only %d of %d PCBs available\n", pcbCnt, wanted);
+    }
+    bench();
+
+    /* start the fuzz from freshly initialized modules */
+    hostSeed(seed);
+    setup(pcbCnt);
+    failed = fuzz(ops);
+    if (failed != 0) {
+        printf("fuzz: FAILED at op %ld of %ld (seed %u)\n", failed, ops, seed);
+        return 1;
+    }
+    printf("fuzz: %ld ops ok (seed %u)\n", ops, seed);
+    return 0;
+}
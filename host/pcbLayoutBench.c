@@ -0,0 +1,138 @@
+/******************************** pcbLayoutBench.c **********************************
+ *
+ * Host-side (x86-64 Linux) microbenchmark for the pcb_t field layout.
+ *
+ * Compares the current pcb_t (hot queue/semaphore/time fields first, 
+ * processor state last) against the previous layout, in which p_s sat 
+ * between the tree links and p_time/p_semAdd. Both structs hold the same 
+ * fields, only in a different order, so the two are the same size. For 
+ * each layout it reports:
+ *   - the bytes and cache lines spanned by the fields a queue operation 
+ *     touches (p_next, p_prev, p_queue, p_semAdd, p_time);
+ *   - ns per enqueue+dequeue over a ready-queue-like ring of PCBs that are 
+ *     visited in shuffled order, so each PCB visit misses the data cache.
+ *
+ * Usage: make bench && ./pcbLayoutBench [pcbs] [rounds]
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#include "h/hostShim.h"
+#include "../h/types.h"
+
+#define CACHELINE       64
+#define DEFAULTPCBS     65536
+#define DEFAULTROUNDS   20
+
+/* The fields of the current pcb_t, in the order before the hot/cold reordering
+ * (the fields added since then follow p_supportStruct) */
+typedef struct oldpcb_t {
+    struct oldpcb_t *p_next;
+    struct oldpcb_t *p_prev;
+    struct oldpcb_t **p_queue;
+    struct oldpcb_t *p_prnt;
+    struct oldpcb_t *p_child;
+    struct oldpcb_t *p_next_sib;
+    struct oldpcb_t *p_prev_sib;
+    state_t p_s;
+    cpu_t   p_time;
+    int     *p_semAdd;
+    support_t *p_supportStruct;
+    int     p_pid;
+    int     p_tickets;
+    int     p_missed;
+    int     p_sysNum;
+    cpu_t   p_sysStart;
+    int     p_level;
+    cpu_t   p_sliceStart;
+    cpu_t   p_burst;
+    unsigned int p_pass;
+    unsigned int p_stride;
+    cpu_t   p_period;
+    cpu_t   p_budget;
+    cpu_t   p_remaining;
+    cpu_t   p_deadline;
+    int     p_util;
+    int     p_jobDone;
+} oldpcb_t;
+
+/* Bytes spanned by the hot fields, from the first to the end of the last */
+#define HOTSPAN(T) \
+    (MAX(MAX(offsetof(T, p_next) + sizeof(void *), offsetof(T, p_prev) + sizeof(void *)), \
+         MAX(MAX(offsetof(T, p_queue) + sizeof(void *), offsetof(T, p_semAdd) + sizeof(void *)), \
+             offsetof(T, p_time) + sizeof(cpu_t))) \
+     - MIN(MIN(offsetof(T, p_next), offsetof(T, p_prev)), \
+           MIN(MIN(offsetof(T, p_queue), offsetof(T, p_semAdd)), offsetof(T, p_time))))
+
+/*
+ * One round: every PCB is dequeued from the head of the ring, has its 
+ * semaphore and time fields updated as the scheduler/ASL would, and is 
+ * enqueued again at the tail. The ring starts in shuffled order.
+ */
+#define QUEUEBENCH(T, name) \
+HIDDEN double name(T *pcbs, int *order, int n, int rounds) { \
+    T *tail, *head, *p; \
+    int i, r; \
+    double t0; \
+    for (i = 0; i < n; i++) { \
+        p = &pcbs[order[i]]; \
+        p->p_next = &pcbs[order[(i + 1) % n]]; \
+        p->p_prev = &pcbs[order[(i + n - 1) % n]]; \
+        p->p_queue = (T **) &tail; \
+        p->p_semAdd = (int *) 0; \
+        p->p_time = 0; \
+    } \
+    tail = &pcbs[order[n - 1]]; \
+    t0 = hostNow(); \
+    for (r = 0; r < rounds; r++) { \
+        for (i = 0; i < n; i++) { \
+            /* dequeue head */ \
+            head = tail->p_next; \
+            tail->p_next = head->p_next; \
+            head->p_next->p_prev = tail; \
+            head->p_queue = (T **) 0; \
+            head->p_semAdd = (int *) 0; \
+            head->p_time += r; \
+            /* enqueue at tail */ \
+            head->p_next = tail->p_next; \
+            head->p_prev = tail; \
+            tail->p_next->p_prev = head; \
+            tail->p_next = head; \
+            head->p_queue = (T **) &tail; \
+            tail = head; \
+        } \
+    } \
+    return (hostNow() - t0) / ((double) n * rounds); \
+}
+
+QUEUEBENCH(oldpcb_t, benchOld)
+QUEUEBENCH(pcb_t, benchNew)
+
+HIDDEN void report(const char *name, size_t size, size_t span, double ns) {
+    printf("%-8s sizeof=%4lu  hot bytes spanned=%4lu  hot cache lines=%lu  %7.2f ns/enqueue+dequeue\n",
+           name, (unsigned long) size, (unsigned long) span,
+           (unsigned long) ((span + CACHELINE - 1) / CACHELINE), ns);
+}
+
+int main(int argc, char **argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : DEFAULTPCBS;
+    int rounds = (argc > 2) ? atoi(argv[2]) : DEFAULTROUNDS;
+    oldpcb_t *oldPcbs = calloc(n, sizeof(oldpcb_t));
+    pcb_t *newPcbs = calloc(n, sizeof(pcb_t));
+    int *order = malloc(n * sizeof(int));
+
+    if (n < 2 || oldPcbs == (oldpcb_t *) 0 || newPcbs == (pcb_t *) 0 || order == (int *) 0) {
+        fprintf(stderr, "usage: %s [pcbs >= 2] [rounds]\n", argv[0]);
+        return 1;
+    }
+    hostShuffle(order, n, 1);
+
+    printf("%d PCBs, %d rounds\n", n, rounds);
+    report("old", sizeof(oldpcb_t), HOTSPAN(oldpcb_t), benchOld(oldPcbs, order, n, rounds));
+    report("new", sizeof(pcb_t), HOTSPAN(pcb_t), benchNew(newPcbs, order, n, rounds));
+
+    free(oldPcbs);
+    free(newPcbs);
+    free(order);
+    return 0;
+}
@@ -4,7 +4,11 @@
 *
 *  This module manages the active semaphore descriptors and their associated
 *  process queues. It provides routines to insert, remove, and query processes
-*  blocked on semaphores, as well as initializing the semaphore descriptor free list.
+*  blocked on semaphores, as well as initializing the semaphore descriptor cache.
+*
+*  Active descriptors are kept in a hash table of SEMDHASHSIZE buckets keyed on
+*  s_semAdd, so locating a semaphore's descriptor costs the same regardless of
+*  how many semaphores are currently active.
 *
 *  Written by Luka Bagashvili, Rosalie Lee
 */
@@ -13,32 +17,53 @@
 #include "../h/pcb.h"    
 #include "../h/const.h"  
 #include "../h/types.h"  
+#include "../h/slab.h"
+
 
+HIDDEN semd_t *semdHash[SEMDHASHSIZE];   /* ASL buckets: each holds the descriptors of the active semaphores hashing to it. */
+HIDDEN slabcache_t semdCache;   /* Cache of free semaphore descriptors. */
 
-HIDDEN semd_t *semd_h = NULL;   /* Head of ASL which holds semaphore descriptors for active semaphores. */
-HIDDEN semd_t *semdFree_h = NULL;   /* Head of the free list for semaphore descriptors. */
+
+/* semdHashIdx maps a semaphore's physical address onto its ASL bucket.
+ * Semaphores are word-aligned ints, so the low two bits carry no information
+ * and are discarded before masking with the (power of two) bucket count.
+ * Input:
+ *    semAdd - Pointer to the semaphore's physical address.
+ * Return: Index of the bucket in semdHash that holds semAdd's descriptor (if any). */
+#define semdHashIdx(semAdd)     ((((memaddr) (semAdd)) >> SEMDHASHSHIFT) & (SEMDHASHSIZE - 1))
 
 
 /* search_semd searches for a semaphore descriptor in the ASL based on the semaphore's physical address.
  * Input:
  *    semAdd - Pointer to the semaphore's physical address.
  *    prev   - Address of a pointer variable that will be set to point to the descriptor
- *             immediately preceding the found descriptor, or remain NULL if the found
- *             descriptor is at the head (or if the ASL is empty).
- * Precondition: The ASL is maintained in sorted order based on the s_semAdd field.
+ *             immediately preceding the found descriptor in its bucket, or NULL if the
+ *             found descriptor is at the head of its bucket (or if the bucket is empty).
+ * Precondition: None; each bucket holds only a handful of descriptors, so the
+ *               search cost does not grow with the number of active semaphores.
  * Return: Pointer to the semaphore descriptor with s_semAdd equal to semAdd if found; otherwise, returns NULL. */
 static semd_t *search_semd (int *semAdd, semd_t **prev) {
-    semd_t *curr = semd_h;
+    semd_t *curr = semdHash[semdHashIdx(semAdd)];
     *prev = NULL;
-    while (curr != NULL && curr->s_semAdd < semAdd) {
+    while (curr != NULL && curr->s_semAdd != semAdd) {
         *prev = curr;
         curr = curr->s_next;
     }
-    /*Check if the current descriptor matches the semaphore address*/
-    if (curr != NULL && curr->s_semAdd == semAdd) {
-        return curr;
+    return curr;
+}
+
+/* unlink_semd removes an (empty) descriptor from its ASL bucket and returns it to the descriptor cache.
+ * Input:
+ *    sd   - Pointer to the descriptor to release.
+ *    prev - The descriptor preceding sd in its bucket, as reported by search_semd (NULL if sd is the bucket head).
+ * Return: None. */
+static void unlink_semd (semd_t *sd, semd_t *prev) {
+    if (prev == NULL) {
+        semdHash[semdHashIdx(sd->s_semAdd)] = sd->s_next;
+    } else {
+        prev->s_next = sd->s_next;
     }
-    return NULL;
+    slabFree(&semdCache, sd);
 }
 
 /* insertBlocked inserts a PCB into the blocked queue for a semaphore.
@@ -48,7 +73,7 @@ static semd_t *search_semd (int *semAdd, semd_t **prev) {
  * Precondition:
  *    p is a valid PCB.
  * Return:
- *    TRUE if a new semaphore descriptor was needed but none was available;
+ *    TRUE if a new semaphore descriptor was needed but none could be allocated;
  *    FALSE otherwise. */
 extern int insertBlocked (int *semAdd, pcb_t *p) {
     semd_t *prev, *sd;
@@ -58,19 +83,18 @@ extern int insertBlocked (int *semAdd, pcb_t *p) {
     
     /*If no descriptor exists for the semaphore*/
     if (sd == NULL) {
-        /* Allocate a new descriptor from the free list if available */
-        if (semdFree_h == NULL) {
+        /* Allocate a new descriptor from the cache, growing it if needed */
+        sd = slabAlloc(&semdCache);
+        if (sd == NULL) {
             return TRUE;
         }
-        sd = semdFree_h;
-        semdFree_h = semdFree_h->s_next;  /* Remove descriptor from free list */
 
         sd->s_semAdd = semAdd;
         sd->s_procQ = mkEmptyProcQ();
 
-        /* Insert the new descriptor between prev and prev->s_next (i.e. curr) */
-        sd->s_next = prev->s_next;
-        prev->s_next = sd;
+        /* Push the new descriptor onto the head of its bucket */
+        sd->s_next = semdHash[semdHashIdx(semAdd)];
+        semdHash[semdHashIdx(semAdd)] = sd;
     }
     
     /* Insert the PCB into the process queue for this semaphore */
@@ -106,9 +130,7 @@ extern pcb_PTR removeBlocked (int *semAdd) {
     
     /* If the queue becomes empty, remove the descriptor from the ASL */
     if (emptyProcQ(sd->s_procQ)) {
-        prev->s_next = sd->s_next;
-        sd->s_next = semdFree_h;
-        semdFree_h = sd;
+        unlink_semd(sd, prev);
     }
     
     return p;
@@ -144,9 +166,7 @@ extern pcb_PTR outBlocked (pcb_PTR p) {
     
     /* Remove the descriptor from the ASL if its queue is now empty */
     if (emptyProcQ(sd->s_procQ)) {
-        prev->s_next = sd->s_next;
-        sd->s_next = semdFree_h;
-        semdFree_h = sd;
+        unlink_semd(sd, prev);
     }
     
     return p;
@@ -172,39 +192,47 @@ extern pcb_PTR headBlocked (int *semAdd) {
 }
 
 
-/* initASL initializes the ASL and free semaphore descriptor list.
+/* removeAllBlocked detaches a semaphore's entire blocked queue with a single descriptor lookup.
+ * The detached PCBs are not visited: their p_semAdd is cleared by spliceProcQ(), in the
+ *    same walk that records their new queue, so the waiters are only walked once.
+ * Input:
+ *    semAdd - Pointer to the semaphore's physical address.
+ * Precondition:
+ *    The ASL may or may not contain the descriptor for semAdd.
+ * Return:
+ *    Tail pointer of the detached process queue (each PCB's p_semAdd still set until
+ *    the queue is handed to spliceProcQ()); NULL if no process was blocked on semAdd. */
+extern pcb_PTR removeAllBlocked (int *semAdd) {
+    semd_t *prev, *sd;
+    pcb_t *tail;
+
+    sd = search_semd(semAdd, &prev);
+    /*No descriptor exists for the semaphore*/
+    if (sd == NULL) {
+        return NULL;
+    }
+
+    tail = sd->s_procQ;
+    sd->s_procQ = mkEmptyProcQ();
+    unlink_semd(sd, prev);
+
+    return tail;
+}
+
+
+/* initASL initializes the ASL buckets and the (initially empty) semaphore descriptor cache.
  * Precondition:
  *    None.
  * Return:
  *    None. */
 extern void initASL () {
-    /* The array now has two extra nodes for the sentinels */
-    static semd_t semdTable[MAXPROC + 2];
     int i;
 
-    /* Set up the head sentinel at index 0 */
-    semdTable[0].s_semAdd = 0;  /* head sentinel */
-    semdTable[0].s_procQ = mkEmptyProcQ();  /* always empty */
-    semdTable[0].s_next = &semdTable[MAXPROC + 1];  /* initially points directly to tail sentinel */
-
-    /* Set up the tail sentinel at index MAXPROC+1 */
-    semdTable[MAXPROC + 1].s_semAdd = (int *) MAXINT;  /* tail sentinel */
-    semdTable[MAXPROC + 1].s_procQ = mkEmptyProcQ();
-    semdTable[MAXPROC + 1].s_next = NULL;
-
-    /* Link free list nodes from index 1 to MAXPROC */
-    for (i = 1; i < MAXPROC; i++) {
-        semdTable[i].s_semAdd = NULL;
-        semdTable[i].s_procQ = NULL;
-        semdTable[i].s_next = &semdTable[i + 1];
+    /* Every bucket starts empty; no sentinels are needed since buckets are unordered */
+    for (i = 0; i < SEMDHASHSIZE; i++) {
+        semdHash[i] = NULL;
     }
-    semdTable[MAXPROC].s_semAdd = NULL;
-    semdTable[MAXPROC].s_procQ = NULL;
-    semdTable[MAXPROC].s_next = NULL;
-
-    /* The free list head starts at index 1 */
-    semdFree_h = &semdTable[1];
 
-    /* The ASL always starts with the head sentinel at index 0 */
-    semd_h = &semdTable[0];
+    /* Descriptors are carved out of RAM frames by insertBlocked() as semaphores become active */
+    initCache(&semdCache, sizeof(semd_t));
 }
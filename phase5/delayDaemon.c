@@ -91,25 +91,28 @@ whose wake up time has passed:
 #include "../h/const.h"
 #include "../h/delayDaemon.h"
 #include "../h/vmSupport.h"
+#include "../h/sysSupport.h"
+#include "../h/slab.h"
 #include "/usr/include/umps3/umps/libumps.h"
 
 /* --- ADL globals --- */
-static delayd_t delaydArray[UPROCMAX];   /* static array of delay event descriptor nodes (Active Delay List (ADL) to keep track of sleeping U-procs) */
-static delayd_t *delaydFree_h;           /* head of free list for unused delay event descriptor nodes */
-static delayd_t *delayd_h;               /* head of active (sorted) list for delay event descriptor nodes */
+static slabcache_t delaydCache;          /* cache of unused delay event descriptor nodes (grows one frame at a time) */
+static delayd_t *delayd_h;               /* head of active (sorted) list for delay event descriptor nodes (Active Delay List (ADL) to keep track of sleeping U-procs) */
 int semDelay;               /* mutex for ADL */
 
+/* allocate a descriptor from the cache; interrupts are off since the slab's frames are shared with the Nucleus */
 static delayd_t *allocDelay(void) {
-    if (!delaydFree_h) return NULL; /* no delay event descriptor node if free list is empty */
-    delayd_t *node = delaydFree_h; /* allocate a descriptor node from free list */
-    delaydFree_h = node->d_next;    /* update the head pointer to the next available node */
+    disableInterrupts();
+    delayd_t *node = slabAlloc(&delaydCache); /* NULL if no frame is left to grow the cache */
+    enableInterrupts();
     return node;
 }
 
-/* return a descriptor to free list */
+/* return a descriptor to the cache */
 static void freeDelay(delayd_t *node) {
-    node->d_next = delaydFree_h;    /* Add the node to the head of the free list */
-    delaydFree_h = node;
+    disableInterrupts();
+    slabFree(&delaydCache, node);
+    enableInterrupts();
 }
 
 /* insert node into active list sorted by d_wakeTime using pointer to pointer to avoid using prev */
@@ -123,14 +126,9 @@ static void insertDelay(delayd_t *node) {
 
 /* Called once at system startup (by test()) */
 void initADL(void) {
-    int i;
-    /* build free list: NULL terminated, single, linearly linked list */
-    for (i = 0; i < UPROCMAX - 1; i++) {
-        delaydArray[i].d_next = &delaydArray[i + 1];
-    }
-    delaydArray[UPROCMAX - 1].d_next = NULL;    /* a dummy node at the tail */
-    delayd_h = NULL;           /* initialize head of delaydArray to NULL */
-    delaydFree_h = &delaydArray[0]; /* just like delaydArray list but will hold unused delay event descriptor nodes */
+    /* descriptors are carved out of RAM frames on demand by allocDelay() */
+    initCache(&delaydCache, sizeof(delayd_t));
+    delayd_h = NULL;           /* initialize head of the ADL to NULL */
     semDelay = 1;
 
     state_t st;
@@ -183,7 +181,7 @@ void delaySyscall(state_t *savedState, int secs) {
     mutex(&(sPtr->sup_delaySem), TRUE); /* P on this proc's private semaphore */
     enableInterrupts();  /* re-enable interrupts */
     /* when woken, return here */
-    LDST(savedState);
+    returnToUProc(sPtr);
 }
 
 /* the daemon that wakes up sleeping U‑procs */
@@ -1,7 +1,7 @@
 /******************************** exceptions.c **********************************
  *
  * This module implements the Nucleus exception handling for Pandos. It directly
- * handles SYSCALL (1–8) requests, while all other exceptions (TLB, Program Trap,
+ * handles SYSCALL (1–8, GETPID, SETSHARES, SETPERIOD, WAITPERIOD, GETINTSTATS) requests, while all other exceptions (TLB, Program Trap,
  * or SYSCALL ≥ 9) are “passed up” to the Support Level if a Support Structure is 
  * defined, or the offending process (and its progeny) is terminated otherwise.
  *
@@ -14,7 +14,10 @@
  *     TLB, and illegal SYSCALL requests.
  *   - Supplies internal helper functions to manage new process creation, 
  *     process termination, Passeren/Verhogen, I/O waits, retrieving CPU time,
- *     waiting for the pseudo-clock, and retrieving a process’s Support Structure.
+ *     waiting for the pseudo-clock, retrieving a process’s Support Structure,
+ *     retrieving a process’s PID, setting a process’s CPU shares, 
+ *     joining and pacing the EDF scheduling class, and reading the 
+ *     interrupt statistics.
  *
  * Execution Flow:
  *   - The General Exception Handler (from `initial.c`) decodes `Cause.ExcCode` 
@@ -27,6 +30,11 @@
  *     which the Scheduler is invoked.
  *   - At the end of any non-blocking SYSCALL handling, this module updates CPU 
  *     usage for the Current Process and resumes it via LDST.
+ *   - SYSCALLs that never give up the CPU (SYS3 unless it blocks, SYS4, 
+ *     SYS6, SYS8, SYS21, SYS22) take a fast path: they read their arguments 
+ *     from, and write v0 into, the saved state in the BIOS Data Page and 
+ *     LDST it straight back. The state is copied into the PCB only when 
+ *     the process blocks.
  *
  * Written by: Luka Bagashvili, Rosalie Lee
  ******************************************************************************/
@@ -39,15 +47,13 @@
 #include "../h/exceptions.h"
 #include "../h/interrupts.h"
 #include "../h/initial.h"
+#include "../h/trace.h"
+#include "../h/sysProfile.h"
 #include "/usr/include/umps3/umps/libumps.h"
 
-void debugExc(int a, int b, int c, int d) {
-    int i =0;
-    i++;
-}
-
 /* Function Prototypes (local to this module) */
 HIDDEN void blockCurrentProcess(int *semAddr);
+HIDDEN void resumeFromBIOS();
 HIDDEN void createNewProcess(state_PTR stateSys, support_t *supportPtr);
 HIDDEN void terminateProcessAndProgeny(pcb_PTR proc);
 HIDDEN void passerenSyscall(int *semAddr);
@@ -56,10 +62,16 @@ HIDDEN void waitIODevice(int lineNum, int devNum, int isReadOperation);
 HIDDEN void getCpuTimeSyscall();
 HIDDEN void waitForClockSyscall();
 HIDDEN void getSupportDataSyscall();
+HIDDEN void getPidSyscall();
+HIDDEN void setSharesSyscall(int pid, int tickets);
+HIDDEN void setPeriodSyscall(cpu_t period, cpu_t budget);
+HIDDEN void waitPeriodSyscall();
+HIDDEN void getIntStatsSyscall(int kind, int index, intstat_PTR stat);
 
 /* Global Variables (from this module’s perspective) */
 int   syscallNumber;   /* Holds the system call code (a0) from the saved state */
-cpu_t currentTOD;      /* Used to track CPU usage for the Current Process */
+cpu_t currentTOD;      /* Used to track CPU usage for the Current Process (TOD ticks) */
+HIDDEN cpu_t sysEntryTOD; /* TOD (raw ticks) at which the SYSCALL being handled entered */
 
 /************************************************************************
  * updateCurrentProcessState
@@ -72,6 +84,23 @@ void updateCurrentProcessState() {
     moveState(savedExceptState, &(currentProcess->p_s));
 }
 
+/************************************************************************
+ * resumeFromBIOS
+ *
+ * Ends a fast-path SYSCALL: charges the time spent in the nucleus to the 
+ * Current Process, records the request in the SYSCALL profile and resumes 
+ * it from the saved state in the BIOS Data Page (its PCB copy of the 
+ * state is stale and is left alone).
+ ************************************************************************/
+HIDDEN void resumeFromBIOS() {
+    STCKTICKS(currentTOD);
+    currentProcess->p_time += (currentTOD - startTOD);
+    startTOD = currentTOD;
+    profileSys(syscallNumber, currentTOD - sysEntryTOD);
+    TRACEEVENT(TRSYSEXIT, currentProcess->p_pid, savedExceptState->s_a0);
+    LDST(savedExceptState);
+}
+
 /************************************************************************
  * blockCurrentProcess
  *
@@ -80,8 +109,10 @@ void updateCurrentProcessState() {
  * the ASL, and clears `currentProcess` so the Scheduler may find a new job.
  ************************************************************************/
 HIDDEN void blockCurrentProcess(int *semAddr) {
-    STCK(currentTOD);
+    STCKTICKS(currentTOD);
     currentProcess->p_time += (currentTOD - startTOD);
+    endBurst(currentProcess);
+    TRACEEVENT(TRBLOCK, currentProcess->p_pid, semAddr);
 
     insertBlocked(semAddr, currentProcess);
     currentProcess = NULL; 
@@ -102,7 +133,8 @@ HIDDEN void createNewProcess(state_PTR stateSys, support_t *supportPtr) {
         /* Populate fields of the new PCB */
         moveState(stateSys, &(newPcb->p_s));
         newPcb->p_supportStruct = supportPtr;
-        insertProcQ(&readyQueue, newPcb);
+        initSchedFields(newPcb, currentProcess); /* children inherit their parent's shares */
+        makeReady(newPcb);
 
         insertChild(currentProcess, newPcb);
 
@@ -116,7 +148,7 @@ HIDDEN void createNewProcess(state_PTR stateSys, support_t *supportPtr) {
     }
 
     /* Charge the time spent handling this SYSCALL to the Current Process */
-    STCK(currentTOD);
+    STCKTICKS(currentTOD);
     currentProcess->p_time += (currentTOD - startTOD);
 
     /* Resume execution of the Current Process */
@@ -125,24 +157,18 @@ HIDDEN void createNewProcess(state_PTR stateSys, support_t *supportPtr) {
 
 
 /************************************************************************
- * terminateProcessAndProgeny (SYS2 - TERMINATEPROCESS or “Die”)
+ * removeTerminatedProcess
  *
- * Recursively terminates the specified process and all of its offspring. 
- * Removes the process from either the Ready Queue or ASL (if blocked), 
- * releases its PCB, and decrements the process count. If the process was 
- * blocked on a non-device semaphore, increments that semaphore.
+ * Takes a single, childless process out of the system: removes it from 
+ * either the Ready Queue or ASL (if blocked), releases its PCB, and 
+ * decrements the process count. If the process was blocked on a 
+ * non-device semaphore, increments that semaphore.
  ************************************************************************/
-HIDDEN void terminateProcessAndProgeny(pcb_PTR proc) {
+HIDDEN void removeTerminatedProcess(pcb_PTR proc) {
     int *semAddr = proc->p_semAdd;
-    
-    /* Recursively kill all children */
-    while (!emptyChild(proc)) {
-        terminateProcessAndProgeny(removeChild(proc));
-    }
 
-    /* Now remove this process itself */
     if (proc == currentProcess) {
-        outChild(proc);
+        /* Running, so on no queue */
     } 
     else if (semAddr != NULL) {
         outBlocked(proc);
@@ -155,33 +181,73 @@ HIDDEN void terminateProcessAndProgeny(pcb_PTR proc) {
             softBlockedCount--;
         }
     } else {
-        /* Must be on the Ready Queue */
-        outProcQ(&readyQueue, proc);
+        /* Must be on a Ready Queue (or sleeping until an EDF release) */
+        outReady(proc);
     }
 
+    leaveEdf(proc);
     freePcb(proc);
     processCount--;
 }
 
 
+/************************************************************************
+ * terminateProcessAndProgeny (SYS2 - TERMINATEPROCESS or “Die”)
+ *
+ * Terminates the specified process and all of its offspring with an 
+ * iterative post-order walk of the process tree, so the nucleus stack 
+ * use does not depend on the depth of the tree. The walk descends 
+ * through p_child to a leaf, kills it (it is always its parent's first 
+ * child, so removeChild() unlinks it in constant time), then resumes 
+ * from the parent; every edge is followed once down and once up.
+ ************************************************************************/
+HIDDEN void terminateProcessAndProgeny(pcb_PTR proc) {
+    pcb_PTR victim = proc;
+    pcb_PTR parent;
+
+    /* Detach the subtree from the rest of the process tree */
+    outChild(proc);
+
+    while (TRUE) {
+        /* Descend to a leaf of what is left of the subtree */
+        while (!emptyChild(victim)) {
+            victim = victim->p_child;
+        }
+
+        if (victim == proc) {
+            removeTerminatedProcess(proc);
+            return;
+        }
+
+        parent = victim->p_prnt;
+        removeChild(parent);
+        removeTerminatedProcess(victim);
+        victim = parent;
+    }
+}
+
+
 /************************************************************************
  * passerenSyscall (SYS3 - PASSEREN)
  *
  * Performs a P operation on the semaphore pointed to by a1. If the 
- * semaphore is negative after decrement, the Current Process becomes 
- * blocked and the Scheduler is invoked. Otherwise, control resumes.
+ * semaphore is negative after decrement, the Current Process's state is 
+ * saved in its PCB, it becomes blocked and the Scheduler is invoked. 
+ * Otherwise, control resumes (fast path).
  ************************************************************************/
 HIDDEN void passerenSyscall(int *semAddr) {
     (*semAddr)--;
     if ((*semAddr) < SEMA4THRESH) {
+        updateCurrentProcessState();
+        /* Profiled when the process is next dispatched (see loadProcessorState()) */
+        currentProcess->p_sysNum = PASSEREN;
+        currentProcess->p_sysStart = sysEntryTOD;
         blockCurrentProcess(semAddr);
         switchProcess();
     }
 
     /* Non-blocking: charge CPU time and resume */
-    STCK(currentTOD);
-    currentProcess->p_time += (currentTOD - startTOD);
-    loadProcessorState(currentProcess);
+    resumeFromBIOS();
 }
 
 
@@ -190,21 +256,20 @@ HIDDEN void passerenSyscall(int *semAddr) {
  *
  * Performs a V operation on the semaphore pointed to by a1. If this V 
  * unblocks a waiting process, that process is moved from the ASL to the 
- * Ready Queue. Control resumes with the Current Process.
+ * Ready Queue. Control resumes with the Current Process (fast path).
  ************************************************************************/
 HIDDEN void verhogenSyscall(int *semAddr) {
     (*semAddr)++;
     if ((*semAddr) <= SEMA4THRESH) {
         pcb_PTR unblocked = removeBlocked(semAddr);
         if (unblocked != NULL) {
-            insertProcQ(&readyQueue, unblocked);
+            TRACEEVENT(TRUNBLOCK, unblocked->p_pid, semAddr);
+            makeReady(unblocked);
         }
     }
 
     /* Charge CPU time and resume */
-    STCK(currentTOD);
-    currentProcess->p_time += (currentTOD - startTOD);
-    loadProcessorState(currentProcess);
+    resumeFromBIOS();
 }
 
 
@@ -236,14 +301,15 @@ HIDDEN void waitIODevice(int lineNum, int devNum, int isReadOperation) {
  * getCpuTimeSyscall (SYS6 - GETCPUTIME)
  *
  * Places the accumulated CPU time of the Current Process (including time 
- * since last dispatch) into v0. Then resumes execution.
+ * since last dispatch) into v0, in microseconds. The Nucleus accounts 
+ * time in raw TOD ticks; this is where it is converted. Then resumes 
+ * execution (fast path).
  ************************************************************************/
 HIDDEN void getCpuTimeSyscall() {
-    STCK(currentTOD);
-    currentProcess->p_s.s_v0 = currentProcess->p_time + (currentTOD - startTOD);
-    currentProcess->p_time += (currentTOD - startTOD);
+    STCKTICKS(currentTOD);
+    savedExceptState->s_v0 = (currentProcess->p_time + (currentTOD - startTOD)) / TIMESCALE;
 
-    loadProcessorState(currentProcess);
+    resumeFromBIOS();
 }
 
 
@@ -252,11 +318,13 @@ HIDDEN void getCpuTimeSyscall() {
  *
  * Performs a P operation on the pseudo-clock semaphore. This always 
  * blocks, since the pseudo-clock semaphore is used for “sleeping” until 
- * a 100ms interrupt. The Current Process transitions to the blocked state,
- * then the Scheduler is invoked.
+ * the next 100ms boundary; the Interval Timer is armed for it if no other 
+ * process is waiting yet. The Current Process transitions to the blocked 
+ * state, then the Scheduler is invoked.
  ************************************************************************/
 HIDDEN void waitForClockSyscall() {
     devSemaphore[PCLOCKIDX]--;
+    armPseudoClock();
     blockCurrentProcess(&devSemaphore[PCLOCKIDX]);
     softBlockedCount++;
     switchProcess();  /* Never returns here */
@@ -268,17 +336,124 @@ HIDDEN void waitForClockSyscall() {
  *
  * Returns the address of the Current Process’s Support Structure in v0, 
  * or NULL if none was provided when the process was created. 
- * Resumes execution afterward.
+ * Resumes execution afterward (fast path).
  ************************************************************************/
 HIDDEN void getSupportDataSyscall() {
-    currentProcess->p_s.s_v0 = (int) currentProcess->p_supportStruct;
+    savedExceptState->s_v0 = (int) currentProcess->p_supportStruct;
+
+    resumeFromBIOS();
+}
+
+
+/************************************************************************
+ * getPidSyscall (SYS21 - GETPID)
+ *
+ * Returns the Current Process’s PID in v0. The PID stays valid until the
+ * process terminates and is not reused for a later process until its 
+ * slot's generation wraps (PIDGENMASK), so it can be handed to other 
+ * processes and looked up with pidToPcb().
+ * Resumes execution afterward (fast path).
+ ************************************************************************/
+HIDDEN void getPidSyscall() {
+    savedExceptState->s_v0 = currentProcess->p_pid;
+
+    resumeFromBIOS();
+}
+
 
-    STCK(currentTOD);
+/************************************************************************
+ * setSharesSyscall (SYS22 - SETSHARES)
+ *
+ * Gives the process named by a1 (a PID, or 0 for the Current Process) 
+ * a2 tickets, its share of the CPU relative to the other processes on 
+ * its MLFQ level. Returns the previous ticket count in v0, or FAIL if the 
+ * PID is stale or the count is outside 1..MAXTICKETS.
+ * Resumes execution afterward (fast path).
+ ************************************************************************/
+HIDDEN void setSharesSyscall(int pid, int tickets) {
+    pcb_PTR target = (pid == 0) ? currentProcess : pidToPcb(pid);
+
+    if (target == NULL || tickets < 1 || tickets > MAXTICKETS) {
+        savedExceptState->s_v0 = FAIL;
+    } else {
+        savedExceptState->s_v0 = target->p_tickets;
+        setShares(target, tickets);
+    }
+
+    resumeFromBIOS();
+}
+
+
+/************************************************************************
+ * setPeriodSyscall (SYS23 - SETPERIOD)
+ *
+ * Moves the Current Process into the EDF scheduling class with period a1 
+ * and CPU budget a2 per period (microseconds), subject to the admission 
+ * test in joinEdf(); calling it again changes the reservation. Its first 
+ * job is released at once. Returns OK in v0, or FAIL if the reservation 
+ * was refused (the process is then left as it was).
+ ************************************************************************/
+HIDDEN void setPeriodSyscall(cpu_t period, cpu_t budget) {
+    STCKTICKS(currentTOD);
     currentProcess->p_time += (currentTOD - startTOD);
+
+    if (joinEdf(currentProcess, period, budget, currentTOD)) {
+        currentProcess->p_s.s_v0 = OK;
+        /* Charge the burst that ends here, but not to the first job's fresh budget */
+        endBurst(currentProcess);
+        currentProcess->p_remaining = currentProcess->p_budget;
+        /* Re-dispatch it as an EDF process, with its budget on the PLT */
+        makeReady(currentProcess);
+        currentProcess = NULL;
+        switchProcess();
+    }
+
+    currentProcess->p_s.s_v0 = FAIL;
     loadProcessorState(currentProcess);
 }
 
 
+/************************************************************************
+ * waitPeriodSyscall (SYS24 - WAITPERIOD)
+ *
+ * Ends the Current Process’s EDF job: it sleeps until its next release 
+ * (see endJob()). Returns in v0 the number of deadlines it has missed so 
+ * far, or FAIL if it is not in the EDF class.
+ ************************************************************************/
+HIDDEN void waitPeriodSyscall() {
+    STCKTICKS(currentTOD);
+    currentProcess->p_time += (currentTOD - startTOD);
+
+    if (currentProcess->p_period == 0) {
+        currentProcess->p_s.s_v0 = FAIL;
+        loadProcessorState(currentProcess);
+    }
+
+    endBurst(currentProcess);
+    endJob(currentProcess, currentTOD);
+    currentProcess->p_s.s_v0 = currentProcess->p_missed;
+    currentProcess = NULL;
+    switchProcess();
+}
+
+
+/************************************************************************
+ * getIntStatsSyscall (SYS25 - GETINTSTATS)
+ *
+ * Copies the interrupt statistics of line a2 (a1 = INTSTATLINE) or of 
+ * device semaphore index a2 (a1 = INTSTATDEVICE) into the intstat_t at 
+ * a3 (see getIntStat()). The buffer must be mapped without a TLB refill, 
+ * so user-mode requests are forwarded through a Support Level buffer. 
+ * Returns OK in v0, or FAIL if a1 or a2 is out of range.
+ * Resumes execution afterward (fast path).
+ ************************************************************************/
+HIDDEN void getIntStatsSyscall(int kind, int index, intstat_PTR stat) {
+    savedExceptState->s_v0 = getIntStat(kind, index, stat);
+
+    resumeFromBIOS();
+}
+
+
 /************************************************************************
  * passUpOrDie
  *
@@ -289,12 +464,11 @@ HIDDEN void getSupportDataSyscall() {
  * Otherwise, the Current Process is terminated.
  ************************************************************************/
 void passUpOrDie(int exceptionType) {
-    debugExc(1, exceptionType, 0, 0);
     if (currentProcess->p_supportStruct != NULL) {
         moveState(savedExceptState, 
                   &(currentProcess->p_supportStruct->sup_exceptState[exceptionType]));
 
-        STCK(currentTOD);
+        STCKTICKS(currentTOD);
         currentProcess->p_time += (currentTOD - startTOD);
         LDCXT(
             currentProcess->p_supportStruct->sup_exceptContext[exceptionType].c_stackPtr,
@@ -317,16 +491,17 @@ void passUpOrDie(int exceptionType) {
  * - Increments the saved state’s PC by 4 to avoid repeated SYSCALL loops.
  * - Checks if the call was issued in user-mode. If so, treat it as a 
  *   Program Trap.
- * - Otherwise, updates Current Process’s PCB state and routes to the 
- *   appropriate handler for SYS1..SYS8. For invalid calls (≥9), 
- *   treat as Program Trap or pass up to the Support Level.
+ * - Otherwise, serves the non-blocking SYSCALLs on the fast path, or 
+ *   updates Current Process’s PCB state and routes to the appropriate 
+ *   handler. For invalid calls (≥9, other than SYS21..SYS24), treat as 
+ *   Program Trap or pass up to the Support Level.
  ************************************************************************/
 void syscallExceptionHandler() {
 
+    STCKTICKS(sysEntryTOD);
     savedExceptState = (state_PTR) BIOSDATAPAGE;
     syscallNumber = savedExceptState->s_a0;
-    
-    debugExc(2, syscallNumber, 0, 0);
+    TRACEEVENT(TRSYSENTER, currentProcess->p_pid, syscallNumber);
     /* Avoid an infinite loop of re-executing SYSCALL */
     savedExceptState->s_pc += WORDLEN;
 
@@ -337,14 +512,52 @@ void syscallExceptionHandler() {
         programTrapHandler();
 		return; /* Ensures no return to the killed process */
     }
-    /* If SYSCALL code is outside 1..8, handle as Program Trap (illegal) */
-    if (syscallNumber < CREATEPROCESS || syscallNumber > GETSUPPORTPTR) {
+    /* If SYSCALL code is outside 1..8 and GETPID..GETINTSTATS, handle as Program Trap (illegal) */
+    if ((syscallNumber < CREATEPROCESS || syscallNumber > GETSUPPORTPTR) && 
+        (syscallNumber < GETPID || syscallNumber > GETINTSTATS)) {
         programTrapHandler();
 		return; /* Same reason as above */
     }
-    debugExc(4, savedExceptState->s_pc, 0, 0);
+
+    /* Fast path: SYSCALLs that do not give up the CPU run on the BIOS Data Page state */
+    switch (syscallNumber) {
+        case PASSEREN:         /* SYS3 */
+            passerenSyscall((int *) savedExceptState->s_a1);
+            return;
+
+        case VERHOGEN:         /* SYS4 */
+            verhogenSyscall((int *) savedExceptState->s_a1);
+            return;
+
+        case GETCPUTIME:       /* SYS6 */
+            getCpuTimeSyscall();
+            return;
+
+        case GETSUPPORTPTR:    /* SYS8 */
+            getSupportDataSyscall();
+            return;
+
+        case GETPID:           /* SYS21 */
+            getPidSyscall();
+            return;
+
+        case SETSHARES:        /* SYS22 */
+            setSharesSyscall(savedExceptState->s_a1, savedExceptState->s_a2);
+            return;
+
+        case GETINTSTATS:      /* SYS25 */
+            getIntStatsSyscall(savedExceptState->s_a1, savedExceptState->s_a2, (intstat_PTR) savedExceptState->s_a3);
+            return;
+
+        default:
+            break;
+    }
+
     /* Update the Current Process's PCB to reflect the saved state */
     updateCurrentProcessState();
+    /* Profiled when the process is next dispatched (see loadProcessorState()) */
+    currentProcess->p_sysNum = syscallNumber;
+    currentProcess->p_sysStart = sysEntryTOD;
 
     switch (syscallNumber) {
         case CREATEPROCESS:    /* SYS1 */
@@ -357,17 +570,11 @@ void syscallExceptionHandler() {
         case TERMINATEPROCESS: /* SYS2 */
             terminateProcessAndProgeny(currentProcess);
             currentProcess = NULL;
+            STCKTICKS(currentTOD);
+            profileSys(TERMINATEPROCESS, currentTOD - sysEntryTOD);
             switchProcess();
             break;
 
-        case PASSEREN:         /* SYS3 */
-            passerenSyscall((int *) currentProcess->p_s.s_a1);
-            break;
-
-        case VERHOGEN:         /* SYS4 */
-            verhogenSyscall((int *) currentProcess->p_s.s_a1);
-            break;
-
         case WAITIO:           /* SYS5 */
             waitIODevice(
                 currentProcess->p_s.s_a1, 
@@ -376,21 +583,20 @@ void syscallExceptionHandler() {
             );
             break;
 
-        case GETCPUTIME:       /* SYS6 */
-            getCpuTimeSyscall();
-            break;
-
         case WAITCLOCK:        /* SYS7 */
             waitForClockSyscall();
             break;
 
-        case GETSUPPORTPTR:    /* SYS8 */
-            getSupportDataSyscall();
+        case SETPERIOD:        /* SYS23 */
+            setPeriodSyscall(currentProcess->p_s.s_a1, currentProcess->p_s.s_a2);
+            break;
+
+        case WAITPERIOD:       /* SYS24 */
+            waitPeriodSyscall();
             break;
 
         default:
-            /* Should never get here if [1..8] was properly checked */
-            debugExc(0xdd, syscallNumber, 0, 0);
+            /* Should never get here if the range was properly checked */
             programTrapHandler();
             return;;
     }
@@ -404,7 +610,6 @@ void syscallExceptionHandler() {
  * instructions, etc.). Invokes passUpOrDie with GENERALEXCEPT.
  ************************************************************************/
 void programTrapHandler() {
-    debugExc(0xd, 0, 0, 0);
     passUpOrDie(GENERALEXCEPT);
 }
 
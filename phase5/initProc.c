@@ -10,6 +10,8 @@
  * A support structure with TLB and general exception contexts to handle TLB-refill and general exceptions. 
  * A private page table initialized for each user process’s address translation. 
  * A processor state set to user-mode with interrupts and the processor local timer enabled. 
+ * Its CPU shares, from uprocTickets: test() sets its own tickets (SYS22) before 
+ * each SYS1 and the new U-proc inherits them.
  * 
  * Written by Rosalie Lee, Luka Bagashvili
  **************************************************************************/
@@ -28,6 +30,12 @@ int p3devSemaphore[PERIPHDEVCNT]; /* Sharable peripheral I/O device, (Disk, Flas
                                                          (Terminal devices): 8 terminals × 2 semaphores = 16 semaphores*/
 int masterSemaphore; /* Private semaphore for graceful conclusion/termination of test */
 
+/* CPU shares (tickets, 1..MAXTICKETS) of U-procs 1..8; raise an entry to give that U-proc more of the CPU */
+HIDDEN int uprocTickets[UPROCMAX] = {
+    DEFAULTTICKETS, DEFAULTTICKETS, DEFAULTTICKETS, DEFAULTTICKETS,
+    DEFAULTTICKETS, DEFAULTTICKETS, DEFAULTTICKETS, DEFAULTTICKETS
+};
+
 
 void test() {
     static support_t supportStruct[UPROCMAX + 1]; /* Initialize the support structure for the process */
@@ -66,7 +74,7 @@ void test() {
 
         for (i = 0; i < PGTBLSIZE; i++) {
             supportStruct[pid].sup_privatePgTbl[i].entryHI = ALLOFF | ((KVSBEGIN + i) << VPNSHIFT) | (pid << ASIDSHIFT);
-			supportStruct[pid].sup_privatePgTbl[i].entryLO = ALLOFF | DIRTYON; 
+			supportStruct[pid].sup_privatePgTbl[i].entryLO = ALLOFF; /* Clean: the first write raises a TLB-Modification (see the Pager) */
         } 
 
         u_procState.s_entryHI = KUSEG | (pid << ASIDSHIFT) | ALLOFF;  /* Set the entry HI for the user process */
@@ -75,6 +83,7 @@ void test() {
         /* Phase 5: private semaphore starts at 0 */
        supportStruct[pid].sup_delaySem = 0;
 
+        SYSCALL(SETSHARES, 0, uprocTickets[pid - 1], 0); /* The U-proc inherits test()'s shares at SYS1 time */
         res = SYSCALL(CREATEPROCESS, (unsigned int) &(u_procState), (unsigned int) &(supportStruct[pid]), 0); /* Create a new process with the processor state and support structure */
         
         /* If the process creation failed, terminate the process */
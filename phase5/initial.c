@@ -22,14 +22,16 @@
 #include "../h/interrupts.h"
 #include "../h/vmSupport.h"
 #include "../h/delayDaemon.h"
+#include "../h/slab.h"
+#include "../h/trace.h"
 #include "/usr/include/umps3/umps/libumps.h"
 
 /* External function declarations */
 extern void test();              /* The "main" test function (see p2test.c) */
+extern char _end[];              /* End of the kernel image (.bss), set by the linker script */
 HIDDEN void genExceptionHandler();/* Internal function for all general exceptions */
 
 /* Global variables for Phase 2 */
-pcb_PTR readyQueue;      /* Tail pointer to the "ready" queue of pcbs */
 pcb_PTR currentProcess;  /* Pointer to the currently running process */
 int processCount;        /* Number of created but not yet terminated processes */
 int softBlockedCount;    /* Number of created but not yet terminated processes 
@@ -79,9 +81,11 @@ HIDDEN void genExceptionHandler() {
  * main - Pandos Nucleus entry point for Phase 2
  *
  *   1. Set Pass Up Vector for Processor 0 (TLB-refill and general exceptions).
- *   2. Init Phase 1 data structures (pcbFree list & ASL).
+ *   2. Init the slab allocator and Phase 1 data structures (PCB cache & ASL).
  *   3. Initialize Phase 2 global variables.
- *   4. Load system-wide Interval Timer (e.g., 100 ms).
+ *   4. Start the pseudo-clock with initPseudoClock(): the Interval Timer 
+ *      stays parked until the first SYS7, when armPseudoClock() loads it 
+ *      for the next 100 ms boundary since boot.
  *   5. Create a single test process and start the scheduler.
  ************************************************************************/
 int main() {
@@ -91,6 +95,8 @@ int main() {
     devregarea_t *deviceRegArea;
     int i;
 
+    TRACEINIT();
+
     /* Set Pass Up Vector */
     passUpPtr = (passupvector_t *) PASSUPVECTOR;
     passUpPtr->tlb_refll_handler = (memaddr) uTLB_RefillHandler;
@@ -98,7 +104,19 @@ int main() {
     passUpPtr->exception_handler = (memaddr) genExceptionHandler;
     passUpPtr->exception_stackPtr = NUCLEUSSTACK;
 
-    /* Init Phase 1 structures (pcbFree list & ASL) */
+    /* Get top of RAM */
+    deviceRegArea = (devregarea_t *) RAMBASEADDR;
+    ramTop = deviceRegArea->rambase + deviceRegArea->ramsize;
+
+    /* SLABSTART is fixed; stop here rather than let the slab hand out the kernel's own BSS */
+    if ((memaddr) _end > SLABSTART) {
+        PANIC();
+    }
+
+    /* Hand every frame between the kernel and the stack frames at the top of RAM to the slab allocator */
+    initSlab(SLABSTART, ramTop - (STCKFRAMES * PAGESIZE));
+
+    /* Init Phase 1 structures (PCB cache & ASL) */
     initPcbs();
     initASL();
 
@@ -106,30 +124,27 @@ int main() {
     /* Init Phase 2 global variables */
     processCount = INITPROCCOUNT;
     softBlockedCount = INITSOFTBLKCOUNT;
-    readyQueue = mkEmptyProcQ();
+    initReadyQueues();
     currentProcess = NULL;
 
     for (i = 0; i < MAXDEVICECNT; i++) {
         devSemaphore[i] = DEVSEMINIT;
     }
 
-    /* Load system-wide Interval Timer (100 ms) */
-    LDIT(PANDOS_CLOCKINTERVAL);
+    /* Start the pseudo-clock; the Interval Timer is only armed while SYS7 waiters exist */
+    initPseudoClock();
 
     /* Create a single process to start the scheduler */
     p = allocPcb();
     if (p != NULL) {
-        /* Get top of RAM */
-        deviceRegArea = (devregarea_t *) RAMBASEADDR;
-        ramTop = deviceRegArea->rambase + deviceRegArea->ramsize;
-
         /* Initialize p's processor state */ 
         p->p_s.s_status = ALLOFF | PANDOS_IEPBITON | TEBITON | PANDOS_CAUSEINTMASK;   /* Enabling interrupts and PLT, and setting kernel-mode to on */
         p->p_s.s_sp = ramTop;
         p->p_s.s_pc = (memaddr) test;
         p->p_s.s_t9 = (memaddr) test;
 
-        insertProcQ(&readyQueue, p);
+        initSchedFields(p, NULL);
+        makeReady(p);
         processCount++;
 
         /* Begin scheduling */
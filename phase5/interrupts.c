@@ -2,10 +2,12 @@
  *
  * This module handles all interrupt-related processing within the Nucleus.
  * 
- *   - Determines the highest-priority pending interrupt and dispatches the
- *     appropriate handler function (PLT, Interval Timer, or I/O).
- *   - If multiple interrupts are pending, they are handled one at a time in 
- *     descending priority order.
+ *   - Runs the pseudo-clock tickless: the Interval Timer is one-shot, armed 
+ *     for the next 100 ms boundary only while a process waits in SYS7.
+ *   - All interrupts pending in one Cause snapshot (PLT, Interval Timer 
+ *     and every device) are processed in one kernel entry, in descending 
+ *     priority order, before a single return to the Current Process or 
+ *     the Scheduler.
  *   - CPU time used while handling the interrupt is generally charged to the 
  *     process responsible for generating the interrupt, with specific rules:
  *       * I/O interrupt handling time is charged to the process that initiated 
@@ -15,9 +17,16 @@
  *         any process, since the Current Process is not responsible for the 
  *         interrupt generation.
  *   - If a process is unblocked due to an I/O device interrupt, its return 
- *     status is stored in the v0 register, and it is placed on the Ready Queue.
+ *     status is stored in the v0 register, and it is placed on the top-level 
+ *     (MLFQTOP) Ready Queue (or the EDF list), preempting the Current 
+ *     Process if the Scheduler ranks it lower (see preempts()).
+ *   - A process whose quantum expires (PLT) is demoted one MLFQ level; an 
+ *     EDF process whose budget is spent sleeps until its next release.
  *   - Once interrupt processing completes, control returns to the Current 
  *     Process or the Scheduler is invoked if no Current Process exists.
+ *   - Counts, per interrupt line and per device (the devSemaphore index 
+ *     space), the interrupts handled, the time spent handling them and 
+ *     the worst latency from kernel entry; SYS25 reads them out.
  *
  *	Written by Rosalie Lee, Luka Bagashvili
  ****************************************************************************/
@@ -30,150 +39,165 @@
  #include "../h/interrupts.h"
  #include "../h/exceptions.h"
  #include "../h/initial.h"
+ #include "../h/trace.h"
  #include "/usr/include/umps3/umps/libumps.h"
 
- HIDDEN int findDeviceNum(int lineNumber); /* function to find the device number associated with the highest-priority interrupt */
- HIDDEN void IOInt(); /* function to handle I/O interrupts */
+ HIDDEN int serviceDevice(int index, int write); /* function to acknowledge one device and V its semaphore */
+ HIDDEN void recordInt(intstat_PTR stat, cpu_t beginTOD); /* function to charge one handler run to a statistics entry */
+ HIDDEN int IOInt(); /* function to handle I/O interrupts */
  HIDDEN void pltTimerInt(); /* function to handle PLT interrupts */
  HIDDEN void intTimerInt(); /* function to handle System-wide Interval Timer interrupts */
 
 /* Global Variables (from this module’s perspective) */
-cpu_t interruptTOD; /* the value on the Time of Day clock when the Interrupt Handler module is first entered */
+HIDDEN cpu_t clockBase; /* TOD at boot (raw ticks): pseudo-clock ticks fall on clockBase + k * 100 ms */
+HIDDEN int clockArmed; /* TRUE while the Interval Timer is loaded for the next tick */
+cpu_t interruptTOD; /* the value on the Time of Day clock (raw ticks) when the Interrupt Handler module is first entered */
 cpu_t remainingTime; /* the amount of time left on the Current Process' quantum when the interrupt was generated */
+HIDDEN intstat_t lineStats[INTLINECNT]; /* statistics per interrupt line */
+HIDDEN intstat_t devStats[MAXDEVICECNT]; /* statistics per device semaphore (PCLOCKIDX: the pseudo-clock) */
 
  /************************************************************************
-  * findDeviceNum - Identifies the device number for the highest-priority 
-  *                 pending interrupt on a given interrupt line.
-  *
-  *   - Examines the Interrupt Devices Bit Map associated with the specified
-  *     line to detect which device (0-7) is responsible for the interrupt.
-  *   - Returns the device number (0 through 7) corresponding to the highest-
-  *     priority pending interrupt on that line.
+  * recordInt - Adds one handler run, begun at beginTOD and ending now, 
+  *             to stat: its count, total time, and worst latency from 
+  *             kernel entry (interruptTOD).
   ************************************************************************/
- HIDDEN int findDeviceNum(int lineNumber) {
-	 devregarea_t *temp; /* device register area to help find device number */
-	 unsigned int bitMap; /* bit map for the specified interrupt line */
- 
-	 /* Initialize temp and bitMap to determine which device number is associated with the highest-priority interrupt */
-	 temp = (devregarea_t *) RAMBASEADDR; 
-	 bitMap = temp->interrupt_dev[lineNumber - OFFSET];
- 
-	 /* Determine which device number is associated with the highest-priority interrupt based on the address of bitMap */
-	 if ((bitMap & DEV0INT) != ALLOFF) {
-		 return DEV0;
-	 }
-	 if ((bitMap & DEV1INT) != ALLOFF) {
-		 return DEV1;
-	 }
-	 if ((bitMap & DEV2INT) != ALLOFF) {
-		 return DEV2;
-	 }
-	 if ((bitMap & DEV3INT) != ALLOFF) {
-		 return DEV3;
+ HIDDEN void recordInt(intstat_PTR stat, cpu_t beginTOD) {
+	 cpu_t endTOD;
+
+	 STCKTICKS(endTOD);
+	 stat->is_count++;
+	 stat->is_time += endTOD - beginTOD;
+	 if ((endTOD - interruptTOD) > stat->is_maxLatency) {
+		 stat->is_maxLatency = endTOD - interruptTOD;
 	 }
-	 if ((bitMap & DEV4INT) != ALLOFF) {
-		 return DEV4;
+ }
+
+ /************************************************************************
+  * getIntStat - Copies the statistics of interrupt line index (kind 
+  *              INTSTATLINE) or of device semaphore index (kind 
+  *              INTSTATDEVICE) into stat. Returns OK, or FAIL if kind or 
+  *              index is out of range.
+  ************************************************************************/
+ int getIntStat(int kind, int index, intstat_PTR stat) {
+	 intstat_PTR src;
+
+	 if (kind == INTSTATLINE && index >= LINE1 && index < INTLINECNT) {
+		 src = &lineStats[index];
 	 }
-	 if ((bitMap & DEV5INT) != ALLOFF) {
-		 return DEV5;
+	 else if (kind == INTSTATDEVICE && index >= 0 && index < MAXDEVICECNT) {
+		 src = &devStats[index];
 	 }
-	 if ((bitMap & DEV6INT) != ALLOFF) {
-		 return DEV6;
+	 else {
+		 return FAIL;
 	 }
-	 /* default to device 7 if not found above */
-	 return DEV7;
+	 *stat = *src;
+	 return OK;
  }
- 
+
  /************************************************************************
-  * IOInt - Handles I/O interrupts occurring on interrupt lines 3-7. 
+  * serviceDevice - Completes one pending operation on one device.
   *
-  *   - Determines the line number (3-7) and the specific device (0-7) 
-  *     that caused the highest-priority interrupt.
   *   - Stores off the device status code and acknowledges the interrupt 
-  *     by writing the acknowledge command to the device register.
+  *     by writing the acknowledge command to the device register 
+  *     (transmit sub-device if write is TRUE, receive/only otherwise).
   *   - Performs a V operation on the semaphore for the device, unblocking 
-  *     the waiting process (if any), placing its status code in v0, and 
-  *     moving it to the Ready Queue.
-  *   - Decrements the softBlockedCount when a process is unblocked.
-  *   - Charges the CPU time spent handling the interrupt to the process
-  *     responsible for generating the I/O request if that process exists.
+  *     the waiting process (if any), placing its status code in v0, 
+  *     boosting it to MLFQTOP and moving it to the Ready Queue.
+  *   - Decrements the softBlockedCount when a process is unblocked, and 
+  *     charges it the CPU time spent acknowledging its device.
+  *   - Records the run in the device's statistics.
+  *   - Returns TRUE if the unblocked process outranks the Current Process.
   ************************************************************************/
- HIDDEN void IOInt() {
-	 cpu_t currentTOD;
-	 int lineNum;			/* the line number that the highest-priority interrupt occurred on */
-	 int devNum;				/* the device number that the highest-priority interrupt occurred on */
-	 int index;				/* the index in device register of the device associated with the highest-priority interrupt */
+ HIDDEN int serviceDevice(int index, int write) {
+	 cpu_t beginTOD;			/* when servicing this device began */
+	 cpu_t endTOD;			/* when servicing this device ended */
 	 devregarea_t *temp;		/* Device register area that we can use to determine the status code */
-	 int statusCode;			/* The status code from the device register associated with the device that corresponds to the highest-priority interrupt */
+	 int statusCode;			/* The status code from the device register */
+	 int semIndex;			/* index in devSemaphore of the semaphore to V */
 	 pcb_PTR unblockedPcb;	/* pcb originally initiated the I/O request */
- 
-	 /* Determine exactly which line number the interrupt occurred, to initialize lineNum */
-	 if (((savedExceptState->s_cause) & LINE3INT) != ALLOFF) {
-		 lineNum = LINE3;
-	 }
-	 else if (((savedExceptState->s_cause) & LINE4INT) != ALLOFF) {
-		 lineNum = LINE4;
-	 }
-	 else if (((savedExceptState->s_cause) & LINE5INT) != ALLOFF) {
-		 lineNum = LINE5;
-	 }
-	 else if (((savedExceptState->s_cause) & LINE6INT) != ALLOFF) {
-		 lineNum = LINE6;
-	 }
-	 else {
-		 lineNum = LINE7;
-	 }
- 
-	 devNum = findDeviceNum(lineNum); /* Initialize with the device number associated with the highest-priority interrupt */	
-	 index = ((lineNum - OFFSET) * DEVPERINT) + devNum; /* Initialize the index in devSemaphore of the device associated with the highest-priority interrupt */
-	 temp = (devregarea_t *) RAMBASEADDR; /* initialization of temp */
-	 
-	 /* if the highest-priority interrupt occurred on line 7 and if the device's status code is not 1, the device is not "Ready" (write interrupt) */
-	 if ((lineNum == LINE7) && (((temp->devreg[index].t_transm_status) & STATUSON) != READY)){
-		 /* Terminal write interrupt */ 
+
+	 STCKTICKS(beginTOD);
+	 temp = (devregarea_t *) RAMBASEADDR;
+	 if (write) {
+		 /* Terminal write interrupt: the "write" semaphore is (index + DEVPERINT) */
 		 statusCode = temp->devreg[index].t_transm_status;
 		 temp->devreg[index].t_transm_command = ACK;
-
-		 /* Perform V operation on the "write" semaphore (index + DEVPERINT) */
-		 unblockedPcb = removeBlocked(&devSemaphore[index + DEVPERINT]);
-		 devSemaphore[index + DEVPERINT]++; 
+		 semIndex = index + DEVPERINT;
 	 }
-	 /* Otherwise, the highest-priority interrupt either did not occur on a terminal device or it was a read interrupt on a terminal device */
-	 else{
-		 /* Terminal read interrupt, or a non-terminal device interrupt */ 
+	 else {
+		 /* Terminal read interrupt, or a non-terminal device interrupt */
 		 statusCode = temp->devreg[index].t_recv_status;
 		 temp->devreg[index].t_recv_command = ACK;
-
-		 /* Perform V operation on the "read" semaphore (index) */
-		 unblockedPcb = removeBlocked(&devSemaphore[index]);
-		 devSemaphore[index]++;
+		 semIndex = index;
 	 }
-	 
-	 /* If no process was blocked on this device, just return to current or next process. */
-	 if (unblockedPcb == NULL){
-		 if (currentProcess != NULL){
-			 updateCurrentProcessState();
-			 currentProcess->p_time = currentProcess->p_time + (interruptTOD - startTOD); /* charge CPU time to Current Process */
-			 setTIMER(remainingTime);
-			 loadProcessorState(currentProcess); /* Return control to the Current Process */
-		 }
-		 switchProcess(); /* Execute the next process on the Ready Queue if there is no Current Process */
+
+	 /* Perform V operation on the device semaphore */
+	 unblockedPcb = removeBlocked(&devSemaphore[semIndex]);
+	 devSemaphore[semIndex]++;
+	 TRACEEVENT(TRINTDEV, 0, semIndex);
+	 if (unblockedPcb == NULL) {
+		 recordInt(&devStats[semIndex], beginTOD);
+		 return FALSE;
 	 }
-	 
-	 /* unblockedPcb is not NULL */
+	 TRACEEVENT(TRUNBLOCK, unblockedPcb->p_pid, &devSemaphore[semIndex]);
+
 	 unblockedPcb->p_s.s_v0 = statusCode; /* Place the status code in the newly unblocked pcb's v0 register */
-	 insertProcQ(&readyQueue, unblockedPcb); /* Turn "blocked" state to a "ready" state */
-	 softBlockedCount--; 
-	 /* if there is a Current Process to return control to */
-	 if (currentProcess != NULL){ 
-		 updateCurrentProcessState(); /* Update the Current Process' processor state before resuming process' execution */
-		 setTIMER(remainingTime); /* Set the PLT to the remaining time left on the Current Process' quantum when the interrupt handler was first entered */
-		 currentProcess->p_time = currentProcess->p_time + (interruptTOD - startTOD); /* Update the accumulated processor time used by the Current Process */
-		 STCK(currentTOD); /* Store the current value on the Time of Day clock into currentTOD */
-		 unblockedPcb->p_time = unblockedPcb->p_time + (currentTOD - interruptTOD); /* Charge the process associated with the I/O interrupt with the CPU time needed */
-		 loadProcessorState(currentProcess); /* Return control to the Current Process */
+	 unblockedPcb->p_level = MLFQTOP; /* It gave up the CPU to wait for I/O: boost it */
+	 makeReady(unblockedPcb); /* Turn "blocked" state to a "ready" state */
+	 softBlockedCount--;
+	 STCKTICKS(endTOD);
+	 unblockedPcb->p_time = unblockedPcb->p_time + (endTOD - beginTOD); /* Charge the process associated with the I/O interrupt with the CPU time needed */
+	 recordInt(&devStats[semIndex], beginTOD);
+	 return (currentProcess != NULL) && preempts(unblockedPcb, currentProcess);
+ }
+
+ /************************************************************************
+  * IOInt - Handles I/O interrupts occurring on interrupt lines 3-7. 
+  *
+  *   - Drains every pending device interrupt in this one kernel entry: 
+  *     for each line (3-7) asserted in Cause, and each device (0-7) set 
+  *     in that line's Interrupting Devices Bit Map, the device is 
+  *     serviced by serviceDevice(). A terminal with both a write and a 
+  *     read completion pending has both serviced, write first.
+  *   - Returns TRUE if any unblocked process outranks the Current 
+  *     Process (preempts()); intTrapH() makes the scheduling decision.
+  ************************************************************************/
+ HIDDEN int IOInt() {
+	 int lineNum;			/* interrupt line being drained */
+	 int devNum;				/* device on that line */
+	 int index;				/* the index in device register of the device */
+	 unsigned int bitMap;	/* pending devices on lineNum */
+	 int serviced;			/* TRUE once the terminal's transmit side was serviced */
+	 int preempt;			/* TRUE if an unblocked process outranks the Current Process */
+	 devregarea_t *temp;		/* Device register area holding the bit maps */
+	 cpu_t lineTOD;			/* when draining lineNum began */
+
+	 temp = (devregarea_t *) RAMBASEADDR;
+	 preempt = FALSE;
+	 for (lineNum = LINE3; lineNum <= LINE7; lineNum++) {
+		 if (((savedExceptState->s_cause) & (LINE1INT << (lineNum - LINE1))) == ALLOFF) {
+			 continue;
+		 }
+		 STCKTICKS(lineTOD);
+		 bitMap = temp->interrupt_dev[lineNum - OFFSET];
+		 for (devNum = DEV0; devNum <= DEV7; devNum++) {
+			 if ((bitMap & (DEV0INT << devNum)) == ALLOFF) {
+				 continue;
+			 }
+			 index = ((lineNum - OFFSET) * DEVPERINT) + devNum;
+			 serviced = FALSE;
+			 /* on line 7 a transmit status other than "Ready" is a write completion */
+			 if ((lineNum == LINE7) && (((temp->devreg[index].t_transm_status) & STATUSON) != READY)) {
+				 preempt |= serviceDevice(index, TRUE);
+				 serviced = TRUE;
+			 }
+			 if ((lineNum != LINE7) || !serviced || (((temp->devreg[index].t_recv_status) & STATUSON) != READY)) {
+				 preempt |= serviceDevice(index, FALSE);
+			 }
+		 }
+		 recordInt(&lineStats[lineNum], lineTOD);
 	 }
-	 switchProcess(); /* Execute the next process on the Ready Queue if there is no Current Process */
+	 return preempt;
  }
  
  /************************************************************************
@@ -182,58 +206,83 @@ cpu_t remainingTime; /* the amount of time left on the Current Process' quantum
   *   - Copies the saved processor state into the Current Process’s PCB.
   *   - Adds the CPU time from when the process began executing to now 
   *     into the Current Process’s p_time.
-  *   - Places the Current Process back on the Ready Queue, as its quantum 
-  *     has expired.
-  *   - Invokes the Scheduler to select another process to execute.
-  *   - If there is no Current Process, the system triggers a PANIC.
+  *   - Hands the Current Process to quantumExpired(): an MLFQ process that 
+  *     used its whole quantum is demoted one level and placed back on the 
+  *     Ready Queue for that level; an EDF process is requeued, or put to 
+  *     sleep until its next release if its budget is spent.
+  *   - Leaves no Current Process, so intTrapH() calls the Scheduler.
+  *   - If there is no Current Process, the PLT was set to end a Wait State 
+  *     at an EDF release: the Scheduler will release it.
   ************************************************************************/
  HIDDEN void pltTimerInt() {
 	 cpu_t currentTOD;
  
+	 setTIMER(NEVER);	/* PLT will generate an interrupt on interrupt line 1, so it doesn't call PLT again */
 	 /* if there was a running process when the interrupt was generated */
 	 if (currentProcess != NULL) {
-		 setTIMER(NEVER);	/* PLT will generate an interrupt on interrupt line 1, so it doesn't call PLT again */
 		 updateCurrentProcessState();	/* Move the updated exception state from the BIOS Data Page into the Current Process' processor state */
-		 STCK(currentTOD);		/* Store the current value on the Time of Day clock into currentTOD */
+		 STCKTICKS(currentTOD);		/* Store the current value on the Time of Day clock into currentTOD */
 		 currentProcess->p_time += (currentTOD - startTOD);	/* Update the accumulated processor time */
-		 insertProcQ(&readyQueue, currentProcess);	/* Place back the Current Process on the Ready Queue */
+		 quantumExpired(currentProcess);	/* Demote/requeue (or throttle) the Current Process */
 		 currentProcess = NULL;	/* No process currently executing */
-		 switchProcess();	/* Call scheduler */
 	 }
-	 PANIC();	/* if current process is NULL */
  }
  
+ /************************************************************************
+  * initPseudoClock - Starts the pseudo-clock with no waiters: the 
+  *                   Interval Timer stays parked until the first SYS7.
+  ************************************************************************/
+ void initPseudoClock() {
+	 STCKTICKS(clockBase);
+	 DISARMIT();
+	 clockArmed = FALSE;
+ }
+
+ /************************************************************************
+  * armPseudoClock - Called when a process blocks on the pseudo-clock.
+  *
+  *   - If the Interval Timer is parked, loads it to go off at the next 
+  *     100 ms boundary since boot, so SYS7 wakes processes on the same 
+  *     tick boundaries a free-running timer would.
+  *   - Otherwise a tick is already pending and there is nothing to do.
+  ************************************************************************/
+ void armPseudoClock() {
+	 cpu_t now;
+	 unsigned int elapsed; /* time since boot, in TOD ticks */
+	 unsigned int interval; /* 100 ms in TOD ticks */
+
+	 if (clockArmed) {
+		 return;
+	 }
+	 STCKTICKS(now);
+	 elapsed = now - clockBase;
+	 interval = USTOTICKS(PANDOS_CLOCKINTERVAL);
+	 LDITTICKS(interval - (elapsed % interval)); /* time left to the next boundary */
+	 clockArmed = TRUE;
+ }
+
  /************************************************************************
   * intTimerInt - Handles the System-wide Interval Timer (line 2).
   *
-  *   - Reloads the Interval Timer with 100ms (CLOCKINTERVAL).
+  *   - Parks the Interval Timer: it is one-shot, re-armed by the next SYS7.
   *   - Performs a V operation on the pseudo-clock semaphore, unblocking 
-  *     all processes waiting on it.
+  *     all processes waiting on it: the whole blocked queue is detached 
+  *     from the ASL and spliced onto the top-level Ready Queue in a single 
+  *     walk that clears each woken PCB's p_semAdd and records its p_queue, 
+  *     so the tick costs time linear in the number of sleepers.
   *   - Resets the pseudo-clock semaphore to 0.
-  *   - Returns to the Current Process with its remaining quantum, or 
-  *     calls switchProcess() if no Current Process is available.
   *   - Time spent handling this interrupt is not charged to any process.
   ************************************************************************/
  HIDDEN void intTimerInt() {
-	 pcb_PTR temp; /* Pointer to a pcb in the Pseudo-Clock semaphore's process queue that we want to unblock and insert into the Ready Queue */
+	 pcb_PTR temp; /* Tail pointer of the Pseudo-Clock semaphore's process queue that we want to unblock and append to the Ready Queue */
 	 
-	 LDIT(PANDOS_CLOCKINTERVAL); /* Place 100 milliseconds back on the Interval Timer for the next Pseudo-clock tick */
+	 DISARMIT(); /* Acknowledge; every waiter is woken below, so no tick is needed until the next SYS7 */
+	 clockArmed = FALSE;
 	 
 	 /* unblocking all pcbs blocked on the Pseudo-Clock semaphore */
-	 while (headBlocked(&devSemaphore[PCLOCKIDX]) != NULL){ 
-		 temp = removeBlocked(&devSemaphore[PCLOCKIDX]); /* Unblock from the first pcb from the Pseudo-Clock semaphore's process queue */
-		 insertProcQ(&readyQueue, temp); /* Place the unblocked pcb back on the Ready Queue */
-		 softBlockedCount--; 
-	 }
+	 temp = removeAllBlocked(&devSemaphore[PCLOCKIDX]); /* Detach the Pseudo-Clock semaphore's whole process queue */
+	 softBlockedCount -= makeReadyAll(temp); /* Place the unblocked pcbs back on the Ready Queue */
 	 devSemaphore[PCLOCKIDX] = INITIALPCSEM; /* Reset the Pseudo-clock semaphore */
-	 /* if there is a Current Process to return control to */
-	 if (currentProcess != NULL){ 
-		 setTIMER(remainingTime); /* The remaining time left on the Current Process' quantum */
-		 updateCurrentProcessState(); /* Update before resuming process' execution */
-		 currentProcess->p_time = currentProcess->p_time + (interruptTOD - startTOD); /* Update the accumulated processor time used by the Current Process */
-		 loadProcessorState(currentProcess); /* Return control to the Current Process */
-	 }
-	 switchProcess(); /* call scheduler if there is no Current Process to return control to */
  }
  
  
@@ -242,26 +291,57 @@ cpu_t remainingTime; /* the amount of time left on the Current Process' quantum
   *
   *   - Initializes module-level globals: interruptTOD, remainingTime, 
   *     and savedExceptState.
-  *   - Determines which interrupt line has the highest priority pending 
-  *     interrupt.
-  *   - Dispatches to the appropriate handler function:
+  *   - Takes one snapshot of Cause and processes every line pending in 
+  *     it, in descending priority order, without leaving the handler:
   *       * pltTimerInt() for line 1
   *       * intTimerInt() for line 2
   *       * IOInt() for lines 3-7
+  *   - Then makes a single scheduling decision: if the quantum expired 
+  *     (no Current Process is left) or an unblocked process outranks the 
+  *     Current Process, the Scheduler runs; otherwise the Current 
+  *     Process resumes with its remaining quantum.
   ************************************************************************/
  void intTrapH(){
-	 STCK(interruptTOD); /* Store when the Interrupt Handler module is first entered into interruptTOD */
+	 unsigned int cause; /* Cause register at entry */
+	 int preempt; /* TRUE if a process unblocked by a device outranks the Current Process */
+	 cpu_t beginTOD; /* when the handler for a timer line began */
+
+	 STCKTICKS(interruptTOD); /* Store when the Interrupt Handler module is first entered into interruptTOD */
 	 remainingTime = getTIMER(); /* Store the remaining time left on the Current Process' quantum */
 	 savedExceptState = (state_PTR) BIOSDATAPAGE; /* Initialize to the state stored at the start of the BIOS Data Page */
+	 cause = savedExceptState->s_cause;
  
-	 /* calling the interrupt handler function based on interrupt type that has the highest priority (i.e., an interrupt occurred on lines 1-2)*/
-	 if (((savedExceptState->s_cause) & LINE1INT) != ALLOFF){ 
+	 if ((cause & LINE1INT) != ALLOFF){ 
+		 STCKTICKS(beginTOD);
+		 TRACEEVENT(TRINTLINE, 0, LINE1);
 		 pltTimerInt(); 
+		 recordInt(&lineStats[LINE1], beginTOD);
 	 }
-	 if (((savedExceptState->s_cause) & LINE2INT) != ALLOFF){ 
+	 if ((cause & LINE2INT) != ALLOFF){ 
+		 STCKTICKS(beginTOD);
+		 TRACEEVENT(TRINTLINE, 0, LINE2);
 		 intTimerInt(); 
+		 recordInt(&lineStats[LINE2], beginTOD);
+		 devStats[PCLOCKIDX] = lineStats[LINE2]; /* the pseudo-clock is the only Interval Timer user */
+	 }
+	 preempt = FALSE;
+	 if ((cause & (LINE3INT | LINE4INT | LINE5INT | LINE6INT | LINE7INT)) != ALLOFF){ 
+		 preempt = IOInt(); 
+	 }
+
+	 /* if there is a Current Process to return control to */
+	 if (currentProcess != NULL){ 
+		 updateCurrentProcessState(); /* Update the Current Process' processor state before resuming process' execution */
+		 setTIMER(remainingTime); /* Set the PLT to the remaining time left on the Current Process' quantum when the interrupt handler was first entered */
+		 currentProcess->p_time = currentProcess->p_time + (interruptTOD - startTOD); /* Update the accumulated processor time used by the Current Process */
+		 if (preempt) {
+			 endBurst(currentProcess);
+			 makeReady(currentProcess); /* Preempted, not demoted: it keeps its level */
+			 currentProcess = NULL;
+		 }
 	 }
-	 /* otherwise, an I/O interrupt occurred (i.e., an interrupt occurred on lines 3-7) */
-	 IOInt(); 
+	 if (currentProcess != NULL){ 
+		 loadProcessorState(currentProcess); /* Return control to the Current Process */
+	 }
+	 switchProcess(); /* Execute the next process on the Ready Queue if there is no Current Process */
  }
- 
\ No newline at end of file
@@ -4,7 +4,19 @@
 *    Module.
 *
 *  This module manages the allocation, deallocation, and 
-*    manipulation of PCBs for a system.
+*    manipulation of PCBs for a system. PCBs are drawn from a
+*    slab cache that grows one RAM frame at a time, so the number
+*    of processes is bounded by free RAM rather than MAXPROC.
+*
+*  Every allocated PCB also owns a slot in the PID table, so a
+*    process can be named by an integer PID and found again in O(1)
+*    (pidToPcb). Like the PCB cache, the table starts empty and takes
+*    a RAM frame from the slab allocator whenever it runs out of free
+*    slots, so it is only as large as the peak number of live
+*    processes needs. A PID carries its slot's generation, which changes
+*    each time the slot is freed, so a PID held after its process
+*    died does not resolve to the slot's next owner until the
+*    generation (PIDGENMASK) wraps.
 *
 *  Written by Rosalie Lee, Luka Bagashvili
 */
@@ -12,40 +24,106 @@
 #include "../h/pcb.h"
 #include "../h/const.h"
 #include "../h/types.h"
+#include "../h/slab.h"
+
+
+/* cache of free PCBs */
+HIDDEN slabcache_t pcbCache;
+
+/* PID table: frames of slots taken from the slab allocator on demand */
+#define PIDSPERFRAME    (PAGESIZE / sizeof(pidslot_t))
+#define PIDFRAMES       ((MAXPIDS + PIDSPERFRAME - 1) / PIDSPERFRAME)
+#define pidSlot(s)      (&pidFrames[(s) / PIDSPERFRAME][(s) % PIDSPERFRAME])
+
+HIDDEN pidslot_t *pidFrames[PIDFRAMES]; /* frames of the table; slot s lives in frame s / PIDSPERFRAME */
+HIDDEN int pidSlots;                    /* number of slots in the frames taken so far */
+HIDDEN int pidFreeHead;                 /* first free slot, or 0 if none (slot 0 is never used) */
+
 
+/* growPidTable takes one more RAM frame for the PID table and puts its slots on the free list.
+ * Return: TRUE if new slots were added; FALSE if the table already spans MAXPIDS slots
+ *    or no RAM frame is left. */
+HIDDEN int growPidTable() {
+    pidslot_t *frame;
+    int slot;
 
-/* head of the free PCB list */
-HIDDEN pcb_PTR pcbFree_h = NULL;
+    if (pidSlots >= MAXPIDS) {
+        return FALSE;
+    }
+    frame = (pidslot_t *) allocFrame();
+    if (frame == NULL) {
+        return FALSE;
+    }
+    pidFrames[pidSlots / PIDSPERFRAME] = frame;
+
+    /* Push the new slots highest first, so they are handed out in ascending order.
+     * Slot 0 is never put on the free list, so no PID is ever 0. */
+    for (slot = pidSlots + PIDSPERFRAME - 1; slot >= pidSlots; slot--) {
+        frame[slot - pidSlots].ps_pcb = NULL;
+        frame[slot - pidSlots].ps_gen = 1;
+        if (slot > 0 && slot < MAXPIDS) {
+            frame[slot - pidSlots].ps_nextFree = pidFreeHead;
+            pidFreeHead = slot;
+        }
+    }
+    pidSlots += PIDSPERFRAME;
+    return TRUE;
+}
 
 
-/* freePcb inserts the PCB pointed to by p at the head of the free PCB list.
+/* freePcb returns the PCB pointed to by p to the PCB cache.
  * Input: p - Pointer to a PCB.
  * Precondition: p is either NULL or points to a valid PCB structure. */
 extern void freePcb(pcb_t *p) {
+    pidslot_t *entry;
+    int slot;
+
     /* If p is NULL, nothing to free. */
     if (p == NULL) return;
 
-    p->p_next = pcbFree_h; 
-    pcbFree_h = p;         
+    /* Release its PID slot; the new generation makes the old PID stale. */
+    slot = p->p_pid & PIDSLOTMASK;
+    entry = pidSlot(slot);
+    entry->ps_pcb = NULL;
+    entry->ps_gen = (entry->ps_gen + 1) & PIDGENMASK;
+    entry->ps_nextFree = pidFreeHead;
+    pidFreeHead = slot;
+
+    slabFree(&pcbCache, p);
 }
 
 
-/* allocPcb removes a PCB from the head of the free list, resets its fields, and returns it.
- * Precondition: The free PCB list (pcbFree_h) has been initialized.
- * Return: Pointer to a PCB if available; otherwise, NULL. */
+/* allocPcb takes a PCB from the PCB cache, resets its fields, and returns it.
+ * Precondition: The PCB cache has been initialized (initPcbs) and the slab allocator given RAM (initSlab).
+ * Return: Pointer to a PCB with a fresh PID if available; otherwise (no RAM frame left to
+ *    grow the PID table or the cache, or all MAXPIDS slots in use), NULL. */
 extern pcb_PTR allocPcb() {
-    /* If the free list is empty, return NULL. */
-    if (pcbFree_h == NULL) {
+    pcb_t *p;
+    pidslot_t *entry;
+    int slot;
+
+    /* Make sure a PID slot is free, growing the table by a frame if needed. */
+    if (pidFreeHead == 0 && !growPidTable()) {
+        return NULL;
+    }
+
+    /* Take a PCB, growing the cache by a frame if needed. */
+    p = slabAlloc(&pcbCache);
+    if (p == NULL) {
         return NULL;
     }
 
-    /* Remove a PCB. */
-    pcb_t *p = pcbFree_h;
-    pcbFree_h = pcbFree_h->p_next;
+    /* Give it a PID slot. */
+    slot = pidFreeHead;
+    entry = pidSlot(slot);
+    pidFreeHead = entry->ps_nextFree;
+    entry->ps_pcb = p;
+    p->p_pid = (entry->ps_gen << PIDSLOTBITS) | slot;
 
     /* Reset all pointer fields to NULL. */
     p->p_next = NULL;
     p->p_prev = NULL;
+    p->p_queue = NULL;
     p->p_prnt = NULL;
     p->p_child = NULL;
     p->p_next_sib = NULL;
@@ -54,26 +132,41 @@ extern pcb_PTR allocPcb() {
     p->p_time = 0;           
     p->p_semAdd = NULL;      
     p->p_supportStruct = NULL; 
+    p->p_sysNum = 0;
 
     return p;
 }
 
 
-/* initPcbs initializes the free PCB list with a static array of PCBs.
+/* initPcbs initializes the (initially empty) PCB cache and the PID table.
  * Precondition: Called once during system initialization.
- * Modification: Uses freePcb() to link each PCB in the array.
- */
+ * Modification: No PCBs or PID slots are set aside up front; allocPcb() grows the
+ *    cache and the PID table on demand. */
 extern void initPcbs() {
-    static pcb_t pcbFreeTable[MAXPROC];
-    int i;
+    initCache(&pcbCache, sizeof(pcb_t));
+
+    pidSlots = 0;
+    pidFreeHead = 0;
+}
 
-    /* Start with an empty free list. */
-    pcbFree_h = NULL;
 
-    /* Link each PCB in the array by calling freePcb(). */
-    for (i = 0; i < MAXPROC; i++) {
-        freePcb(&pcbFreeTable[i]);
+/* pidToPcb returns the live process named by pid.
+ * Input: pid - A PID previously read from some PCB's p_pid (e.g. returned by GETPID).
+ * Return: Pointer to the PCB owning pid; NULL if pid is malformed or its process has
+ *    been freed (the slot is empty, or now belongs to a later generation). */
+extern pcb_PTR pidToPcb(int pid) {
+    pcb_t *p;
+    int slot;
+
+    slot = pid & PIDSLOTMASK;
+    if (pid <= 0 || slot >= pidSlots) {
+        return NULL;
     }
+    p = pidSlot(slot)->ps_pcb;
+    if (p == NULL || p->p_pid != pid) {
+        return NULL;
+    }
+    return p;
 }
 
 
@@ -98,8 +191,11 @@ extern int emptyProcQ(pcb_t *tp) {
  * Input: 
  *    tp - Pointer to the tail pointer of a process queue.
  *    p  - Pointer to a PCB to be inserted.
- * Precondition: If the queue is non-empty, *tp points to a valid tail in a circular queue. */
+ * Precondition: If the queue is non-empty, *tp points to a valid tail in a circular queue.
+ * Modification: Records tp in p->p_queue so outProcQ can verify membership without a walk. */
 extern void insertProcQ(pcb_t **tp, pcb_t *p) {
+    p->p_queue = tp;
+
     /* If the queue is empty, initialize circular list with a single element. */
     if (emptyProcQ(*tp)) {
         p->p_next = p; 
@@ -145,6 +241,7 @@ extern pcb_PTR removeProcQ(pcb_t **tp) {
     /* Clear the removed PCB's pointers. */
     head->p_next = NULL;
     head->p_prev = NULL;
+    head->p_queue = NULL;
     return head;
 }
 
@@ -155,42 +252,34 @@ extern pcb_PTR removeProcQ(pcb_t **tp) {
  *    p  - Pointer to a PCB that should be removed.
  * Precondition: If the queue is non-empty, *tp points to a valid tail of a circular queue.
  * Return: Pointer to the PCB if removal is successful; otherwise, returns NULL.
- * Modification: If p is the head of the queue, use removeProcQ().
+ * Modification: Membership is checked against p->p_queue (set by insertProcQ), so p is
+ *    unlinked in constant time instead of walking the queue to find it.
+ *    If p is the head of the queue, use removeProcQ().
  */
 extern pcb_t *outProcQ(pcb_t **tp, pcb_t *p) {
-    if (emptyProcQ(*tp) || p == NULL) {
+    if (emptyProcQ(*tp) || p == NULL || p->p_queue != tp) {
         return NULL;
     }
 
-    pcb_PTR head = headProcQ(*tp);
-    if (p == head) {
+    if (p == headProcQ(*tp)) {
         return removeProcQ(tp);
     }
 
-    pcb_t *curr = head->p_next;
-    /* Loop until we either circle back to head or find p */
-    while (curr != head && curr != p) {
-        curr = curr->p_next;
-    }
-
-    if (curr == p) {
-        /* Remove p by updating its neighbors */
-        p->p_prev->p_next = p->p_next;
-        p->p_next->p_prev = p->p_prev;
+    /* Remove p by updating its neighbors */
+    p->p_prev->p_next = p->p_next;
+    p->p_next->p_prev = p->p_prev;
 
-        /* Update tail pointer if necessary */
-        if (p == *tp) {
-            *tp = p->p_prev;
-        }
-
-        /* Clear p's links */
-        p->p_next = NULL;
-        p->p_prev = NULL;
-
-        return p;
+    /* Update tail pointer if necessary */
+    if (p == *tp) {
+        *tp = p->p_prev;
     }
 
-    return NULL;
+    /* Clear p's links */
+    p->p_next = NULL;
+    p->p_prev = NULL;
+    p->p_queue = NULL;
+
+    return p;
 }
 
 
@@ -208,6 +297,50 @@ extern pcb_PTR headProcQ(pcb_t *tp) {
 }
 
 
+/* spliceProcQ appends an entire process queue to the end of another one.
+ * Input:
+ *    tp - Pointer to the tail pointer of the destination process queue.
+ *    q  - Tail pointer of the queue to append (e.g. as returned by removeAllBlocked()).
+ * Precondition: q is not on any tail pointer variable other than the caller's copy;
+ *    both queues are either empty or valid circular queues.
+ * Return: Number of PCBs moved onto *tp.
+ * Modification: The two rings are joined in constant time. Every PCB of q is visited
+ *    once to record its new queue in p_queue, clear p_semAdd (so a queue detached by
+ *    removeAllBlocked() needs no walk of its own) and be counted, so the call as a
+ *    whole is linear in the length of q. */
+extern int spliceProcQ(pcb_t **tp, pcb_t *q) {
+    pcb_t *p;
+    int count = 0;
+
+    /* Nothing to append. */
+    if (emptyProcQ(q)) {
+        return 0;
+    }
+
+    p = q;
+    do {
+        p->p_queue = tp;
+        p->p_semAdd = NULL;
+        count++;
+        p = p->p_next;
+    } while (p != q);
+
+    if (!emptyProcQ(*tp)) {
+        /* Join the rings: old tail -> head of q, tail of q -> old head. */
+        pcb_t *head = (*tp)->p_next;
+        pcb_t *qHead = q->p_next;
+
+        (*tp)->p_next = qHead;
+        qHead->p_prev = *tp;
+        q->p_next = head;
+        head->p_prev = q;
+    }
+    *tp = q;
+
+    return count;
+}
+
+
 /* emptyChild checks if the PCB has any children.
  * Input: p - Pointer to a PCB.
  * Precondition: p is either NULL or points to a valid PCB structure.
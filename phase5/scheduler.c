@@ -1,19 +1,46 @@
 /******************************** scheduler.c **********************************
  *
  * This module implements the Scheduler and the Deadlock Detector.
- *   1. Implements a preemptive round-robin scheduling algorithm with a 
- *      time slice of five milliseconds.
- *   2. Ensures every ready process gets an opportunity to execute.
- *   3. If the Ready Queue is not empty, the scheduler removes the PCB at the 
- *      head of the Ready Queue and assigns it to the Current Process field.
- *   4. Loads five milliseconds on the processor’s Local Timer before performing 
- *      an LDST on the processor state stored in the PCB of the Current Process.
- *   5. If the Ready Queue is empty:
- *      - If Process Count is zero, invokes the HALT BIOS instruction.
+ *   0. Processes in the earliest-deadline-first (EDF) class (SYS23) run 
+ *      before all others, earliest deadline first. Each has a period and 
+ *      a CPU budget per period, admitted only while the total utilization 
+ *      stays under EDFMAXUTIL. A process that finishes its job (SYS24) or 
+ *      uses up its budget sleeps until its deadline, which is also its 
+ *      next release; the PLT is always programmed to the earlier of the 
+ *      running process's budget (or quantum) and the next release, and 
+ *      the sleepers count as soft-blocked. A job still unfinished at its 
+ *      deadline counts as a missed deadline.
+ *   1. Otherwise implements a preemptive multi-level feedback queue (MLFQ): one 
+ *      round-robin Ready Queue per level, level 0 being the highest priority.
+ *      A bitmap of non-empty levels makes picking the next process O(1).
+ *   2. A process that uses up its whole quantum (PLT interrupt) is demoted 
+ *      one level; a process unblocked by an I/O interrupt, or woken by the 
+ *      pseudo-clock, goes back to level 0.
+ *   3. Each process's quantum adapts to its own recent CPU bursts (the 
+ *      CPU time it used per dispatch before blocking or being preempted): 
+ *      twice its running average, kept within [QUANTUMMIN, QUANTUMMAX]. 
+ *      CPU-bound processes therefore take fewer PLT interrupts, while 
+ *      processes that block quickly keep short slices.
+ *   4. Within a level, processes share the CPU in proportion to their 
+ *      tickets (stride scheduling): each process advances its pass by 
+ *      its stride (STRIDE1 / tickets) for every 64 TOD ticks of CPU it 
+ *      uses, and the ready process with the smallest pass runs next. A 
+ *      process coming back from being blocked has its pass raised to the 
+ *      global pass, so sleeping does not bank CPU time. Picking within the 
+ *      level scans its Ready Queue, which stays short.
+ *   5. Every MLFQBOOSTINTERVAL microseconds all ready processes are moved 
+ *      back to level 0, so CPU-bound processes are never starved.
+ *   6. If a Ready Queue is not empty, the scheduler removes the PCB with the 
+ *      smallest pass from the highest-priority one and assigns it to the Current Process 
+ *      field, then loads its quantum on the processor’s Local Timer before 
+ *      performing an LDST on its processor state.
+ *   7. If every Ready Queue is empty:
+ *      - If Process Count is zero, prints the SYSCALL profile and invokes 
+ *        the HALT BIOS instruction.
  *      - If Process Count > 0 and Soft-block Count > 0, enters a Wait State.
  *      - If Process Count > 0 and Soft-block Count == 0, invokes PANIC BIOS 
  *        instruction to handle deadlock.
- *   6. Provides utility functions such as:
+ *   8. Provides utility functions such as:
  *      - moveState(): Copies the processor state from one location to another.
  *      - loadProcessorState(): Loads the processor state of the Current Process.
  *
@@ -28,8 +55,33 @@
 #include "../h/interrupts.h"
 #include "../h/initial.h"
 #include "../h/initProc.h"
+#include "../h/trace.h"
+#include "../h/sysProfile.h"
 #include "/usr/include/umps3/umps/libumps.h"
 
+/* MLFQ Ready Queues */
+pcb_PTR readyQueues[MLFQLEVELS];	/* Tail pointers of the Ready Queues, one per level */
+unsigned int readyMap;			/* Bit l is on iff readyQueues[l] is not empty */
+HIDDEN unsigned int globalPass = 0;		/* Pass of the last dispatched process */
+
+/* EDF class */
+HIDDEN pcb_PTR edfReady;		/* Tail pointer of the ready EDF processes */
+HIDDEN pcb_PTR edfSleep;		/* Tail pointer of the EDF processes waiting for their next release */
+HIDDEN int edfUtil = 0;			/* Total utilization of the admitted EDF processes, in 1/EDFUTILSCALE */
+HIDDEN int sliceCut;			/* TRUE if the PLT was loaded with the time to the next release rather than a full slice */
+HIDDEN cpu_t lastBoost = 0;		/* TOD of the last MLFQ boost */
+
+/* Time constants in TOD ticks, scaled from their microsecond values by initReadyQueues() */
+HIDDEN cpu_t quantumMin;		/* QUANTUMMIN */
+HIDDEN cpu_t quantumMax;		/* QUANTUMMAX */
+HIDDEN cpu_t initialBurst;		/* INITIALBURST */
+HIDDEN cpu_t boostInterval;		/* MLFQBOOSTINTERVAL */
+
+/* Highest-priority (lowest-numbered) level whose bit is on in a readyMap value */
+HIDDEN const int firstLevel[1 << MLFQLEVELS] = {
+	0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+
 
 /************************************************************************
  * moveState - Copies a processor state from source to destination.
@@ -56,41 +108,524 @@ void moveState(state_PTR source, state_PTR dest) {
  *
  *   - Updates the Current Process.
  *   - Captures the start time from the Time of Day clock.
+ *   - If the process is returning from a SYSCALL that gave up the CPU, 
+ *     records that request in the SYSCALL profile.
  *   - Performs an LDST to load the processor state.
  ************************************************************************/
 void loadProcessorState(pcb_PTR curr_proc) {
 	currentProcess = curr_proc;
-	STCK(startTOD);  /* Store Time of Day when process starts execution */
+	STCKTICKS(startTOD);  /* Store Time of Day when process starts execution */
+	if (curr_proc->p_sysNum != 0) {
+		profileSys(curr_proc->p_sysNum, startTOD - curr_proc->p_sysStart);
+		curr_proc->p_sysNum = 0;
+	}
+	TRACEEVENT(TRDISPATCH, curr_proc->p_pid, 0);
 	LDST(&(curr_proc->p_s));  /* Load processor state for execution */
 }
 
 /************************************************************************
- * switchProcess - Implements a preemptive round-robin scheduling algorithm.
+ * initReadyQueues - Empties every Ready Queue, and scales the 
+ *                   scheduler's time constants to TOD ticks.
+ ************************************************************************/
+void initReadyQueues() {
+	int level;
+
+	quantumMin = USTOTICKS(QUANTUMMIN);
+	quantumMax = USTOTICKS(QUANTUMMAX);
+	initialBurst = USTOTICKS(INITIALBURST);
+	boostInterval = USTOTICKS(MLFQBOOSTINTERVAL);
+
+	for (level = 0; level < MLFQLEVELS; level++) {
+		readyQueues[level] = mkEmptyProcQ();
+	}
+	readyMap = ALLOFF;
+	edfReady = mkEmptyProcQ();
+	edfSleep = mkEmptyProcQ();
+}
+
+/************************************************************************
+ * initSchedFields - Sets up the scheduling fields of a new process.
+ *
+ *   - It starts on MLFQTOP with the default burst estimate, outside the 
+ *     EDF class.
+ *   - It inherits its parent's tickets and pass, or gets DEFAULTTICKETS 
+ *     and a zero pass if it has no parent (the first process).
+ ************************************************************************/
+void initSchedFields(pcb_PTR p, pcb_PTR parent) {
+	p->p_level = MLFQTOP;
+	p->p_burst = initialBurst;
+	if (parent != NULL) {
+		setShares(p, parent->p_tickets);
+		p->p_pass = parent->p_pass;
+	} else {
+		setShares(p, DEFAULTTICKETS);
+		p->p_pass = 0;
+	}
+	p->p_period = 0;
+	p->p_missed = 0;
+}
+
+/************************************************************************
+ * edfUtilOf - Returns the utilization (budget / period, rounded up) of 
+ *             an EDF reservation in 1/EDFUTILSCALE.
+ ************************************************************************/
+HIDDEN int edfUtilOf(cpu_t period, cpu_t budget) {
+	return ((budget * EDFUTILSCALE) + period - 1) / period;
+}
+
+/* Note: the Scheduler keeps every time (p_time, bursts, deadlines, the 
+   PLT) in raw TOD ticks; only SYS23's microseconds are converted. */
+
+/************************************************************************
+ * joinEdf - Admission test; puts a process in the EDF class.
  *
- *   - Removes the PCB at the head of the Ready Queue.
- *   - Loads five milliseconds on the processor’s Local Timer (PLT).
+ *   - Returns FALSE, leaving the process as it was, if the period or 
+ *     budget is out of range or the new total utilization would exceed 
+ *     EDFMAXUTIL (a process already in the class is re-tested with its 
+ *     old reservation replaced by the new one).
+ *   - Otherwise its first job is released at now, with deadline 
+ *     now + period, and TRUE is returned. The caller makes it ready.
+ *   - period and budget are in microseconds, now in TOD ticks.
+ ************************************************************************/
+int joinEdf(pcb_PTR p, cpu_t period, cpu_t budget, cpu_t now) {
+	int oldUtil = 0;
+	int util;
+
+	if (period < EDFMINPERIOD || period > EDFMAXPERIOD || budget <= 0 || budget > period) {
+		return FALSE;
+	}
+	if (p->p_period != 0) {
+		oldUtil = p->p_util;
+	}
+	util = edfUtilOf(period, budget);
+	if (edfUtil - oldUtil + util > EDFMAXUTIL) {
+		return FALSE;
+	}
+
+	edfUtil += util - oldUtil;
+	p->p_util = util;
+	p->p_period = USTOTICKS(period);
+	p->p_budget = USTOTICKS(budget);
+	p->p_remaining = p->p_budget;
+	p->p_deadline = now + p->p_period;
+	p->p_jobDone = FALSE;
+	return TRUE;
+}
+
+/************************************************************************
+ * leaveEdf - Takes a process out of the EDF class, returning its 
+ *            utilization (no-op for other processes).
+ ************************************************************************/
+void leaveEdf(pcb_PTR p) {
+	if (p->p_period != 0) {
+		edfUtil -= p->p_util;
+		p->p_period = 0;
+	}
+}
+
+/************************************************************************
+ * edfSleepUntilRelease - Parks an EDF process until its deadline.
+ ************************************************************************/
+HIDDEN void edfSleepUntilRelease(pcb_PTR p) {
+	insertProcQ(&edfSleep, p);
+	softBlockedCount++;  /* waiting on the clock, like a SYS7 */
+}
+
+/************************************************************************
+ * endJob - An EDF process has finished its current job at time now.
+ *
+ *   - On time: it sleeps until its deadline, where its next job is 
+ *     released.
+ *   - Late: the deadline is counted as missed and the next job starts 
+ *     at once, with a fresh budget and a deadline one period from now.
+ ************************************************************************/
+void endJob(pcb_PTR p, cpu_t now) {
+	if ((now - p->p_deadline) > 0) {
+		p->p_missed++;
+		p->p_deadline = now + p->p_period;
+		p->p_remaining = p->p_budget;
+		p->p_jobDone = FALSE;
+		makeReady(p);
+	} else {
+		p->p_jobDone = TRUE;
+		edfSleepUntilRelease(p);
+	}
+}
+
+/************************************************************************
+ * releaseJobs - Releases the next job of every sleeping EDF process 
+ *               whose deadline has been reached.
+ *
+ *   - A process that was throttled (budget spent, job not finished) 
+ *     has missed that deadline.
+ *   - The new deadline is one period later, or one period from now if 
+ *     the release itself came more than a period late.
+ ************************************************************************/
+HIDDEN void releaseJobs(cpu_t now) {
+	pcb_PTR p;
+	pcb_PTR next;
+	int last;
+
+	if (emptyProcQ(edfSleep)) {
+		return;
+	}
+	p = headProcQ(edfSleep);
+	do {
+		next = p->p_next;
+		last = (p == edfSleep);
+		if ((now - p->p_deadline) >= 0) {
+			outProcQ(&edfSleep, p);
+			softBlockedCount--;
+			if (!p->p_jobDone) {
+				p->p_missed++;
+			}
+			p->p_deadline += p->p_period;
+			if ((p->p_deadline - now) <= 0) {
+				p->p_deadline = now + p->p_period;
+			}
+			p->p_remaining = p->p_budget;
+			p->p_jobDone = FALSE;
+			insertProcQ(&edfReady, p);
+		}
+		p = next;
+	} while (!last);
+}
+
+/************************************************************************
+ * nextRelease - Returns the earliest deadline among the sleeping EDF 
+ *               processes (edfSleep must not be empty).
+ ************************************************************************/
+HIDDEN cpu_t nextRelease() {
+	pcb_PTR head = headProcQ(edfSleep);
+	pcb_PTR p = head->p_next;
+	cpu_t release = head->p_deadline;
+
+	while (p != head) {
+		if ((p->p_deadline - release) < 0) {
+			release = p->p_deadline;
+		}
+		p = p->p_next;
+	}
+	return release;
+}
+
+/************************************************************************
+ * minDeadline - Returns the ready EDF process with the earliest deadline 
+ *               (edfReady must not be empty).
+ ************************************************************************/
+HIDDEN pcb_PTR minDeadline() {
+	pcb_PTR head = headProcQ(edfReady);
+	pcb_PTR best = head;
+	pcb_PTR p = head->p_next;
+
+	while (p != head) {
+		if ((p->p_deadline - best->p_deadline) < 0) {
+			best = p;
+		}
+		p = p->p_next;
+	}
+	return best;
+}
+
+/************************************************************************
+ * makeReady - Places a process at the tail of the Ready Queue for its
+ *             level (p_level).
+ *
+ *   - An EDF process goes on the EDF ready list instead, or to sleep 
+ *     until its next release if its budget is spent.
+ ************************************************************************/
+void makeReady(pcb_PTR p) {
+	if (p->p_period != 0) {
+		if (p->p_remaining > 0) {
+			insertProcQ(&edfReady, p);
+		} else {
+			p->p_jobDone = FALSE;
+			edfSleepUntilRelease(p);  /* throttled */
+		}
+		return;
+	}
+	insertProcQ(&readyQueues[p->p_level], p);
+	readyMap |= (1 << p->p_level);
+}
+
+/************************************************************************
+ * makeReadyAll - Places a whole process queue (e.g. everything blocked on 
+ *                the pseudo-clock) on the level 0 Ready Queue at once.
+ *
+ *   - Returns the number of processes made ready.
+ *   - Linear in the length of q: spliceProcQ() rewrites each PCB's p_queue 
+ *     and clears its p_semAdd in one walk.
+ *   - p_level is not touched; switchProcess() sets it when each of them 
+ *     is dispatched from level 0.
+ *   - While any process is in the EDF class, q is taken apart instead so 
+ *     an EDF process goes through makeReady() to the EDF lists rather than 
+ *     running from level 0 outside its reservation.
+ ************************************************************************/
+int makeReadyAll(pcb_PTR q) {
+	pcb_PTR p;
+	int count = 0;
+
+	if (edfUtil == 0) {
+		count = spliceProcQ(&readyQueues[MLFQTOP], q);
+	} else {
+		while ((p = removeProcQ(&q)) != NULL) {
+			p->p_semAdd = NULL;
+			if (p->p_period != 0) {
+				makeReady(p);
+			} else {
+				insertProcQ(&readyQueues[MLFQTOP], p);
+			}
+			count++;
+		}
+	}
+
+	if (!emptyProcQ(readyQueues[MLFQTOP])) {
+		readyMap |= (1 << MLFQTOP);
+	}
+	return count;
+}
+
+/************************************************************************
+ * outReady - Removes a process from whichever Ready Queue it is on, 
+ *            including the EDF ready and sleep lists.
+ *
+ *   - Returns the process, or NULL if it was not on a Ready Queue.
+ ************************************************************************/
+pcb_PTR outReady(pcb_PTR p) {
+	int level;
+
+	if (p->p_queue == &edfSleep) {
+		softBlockedCount--;
+	}
+	if (p->p_queue == &edfReady || p->p_queue == &edfSleep) {
+		return outProcQ(p->p_queue, p);
+	}
+
+	if (p->p_queue < &readyQueues[0] || p->p_queue >= &readyQueues[MLFQLEVELS]) {
+		return NULL;
+	}
+	level = p->p_queue - readyQueues;
+	outProcQ(&readyQueues[level], p);
+	if (emptyProcQ(readyQueues[level])) {
+		readyMap &= ~(1 << level);
+	}
+	return p;
+}
+
+/************************************************************************
+ * demoteProcess - Moves a process that used its whole quantum one level
+ *                 down, unless it is already on the lowest level.
+ ************************************************************************/
+void demoteProcess(pcb_PTR p) {
+	if (p->p_level < MLFQLEVELS - 1) {
+		p->p_level++;
+	}
+}
+
+/************************************************************************
+ * endBurst - Folds the CPU time a process used since it was dispatched
+ *            into its average burst length.
+ *
+ *   - Called once p_time is up to date, when the process blocks or is 
+ *     preempted (not when it merely traps into the nucleus and resumes).
+ *   - An EDF process also has the time taken off its budget.
+ ************************************************************************/
+void endBurst(pcb_PTR p) {
+	cpu_t used = p->p_time - p->p_sliceStart;
+
+	p->p_burst = (p->p_burst + used) >> 1;
+	if (p->p_period != 0) {
+		p->p_remaining -= used;
+	}
+	p->p_pass += ((used >> STRIDETIMESHIFT) + 1) * p->p_stride;  /* at least one unit per dispatch */
+}
+
+/************************************************************************
+ * setShares - Gives a process a number of tickets (1..MAXTICKETS).
+ ************************************************************************/
+void setShares(pcb_PTR p, int tickets) {
+	p->p_tickets = tickets;
+	p->p_stride = STRIDE1 / tickets;
+}
+
+/************************************************************************
+ * minPass - Returns the process with the smallest pass on a non-empty 
+ *           Ready Queue (the earliest one on ties).
+ *
+ *   - Passes behind globalPass belong to processes that were blocked 
+ *     while the others ran; they are raised to globalPass first.
+ *   - Passes are compared by signed difference, so they may wrap.
+ ************************************************************************/
+HIDDEN pcb_PTR minPass(pcb_PTR tp) {
+	pcb_PTR head = headProcQ(tp);
+	pcb_PTR best = head;
+	pcb_PTR p = head;
+
+	do {
+		if ((int) (p->p_pass - globalPass) < 0) {
+			p->p_pass = globalPass;
+		}
+		if ((int) (p->p_pass - best->p_pass) < 0) {
+			best = p;
+		}
+		p = p->p_next;
+	} while (p != head);
+	return best;
+}
+
+/************************************************************************
+ * quantumOf - Returns the quantum to load on the PLT for a process: its 
+ *             average burst << QUANTUMSHIFT, clamped to 
+ *             [QUANTUMMIN, QUANTUMMAX].
+ ************************************************************************/
+HIDDEN cpu_t quantumOf(pcb_PTR p) {
+	cpu_t quantum = p->p_burst << QUANTUMSHIFT;
+
+	if (quantum < quantumMin) {
+		return quantumMin;
+	}
+	if (quantum > quantumMax) {
+		return quantumMax;
+	}
+	return quantum;
+}
+
+/************************************************************************
+ * quantumExpired - The PLT went off while a process was running.
+ *
+ *   - Ends its burst and puts it back on a Ready Queue (or, for an EDF 
+ *     process whose budget is spent, to sleep until its next release).
+ *   - An MLFQ process is demoted, unless the PLT was only cut short for 
+ *     an EDF release and the process had not used its whole quantum.
+ ************************************************************************/
+void quantumExpired(pcb_PTR p) {
+	endBurst(p);
+	if (p->p_period == 0 && !sliceCut) {
+		demoteProcess(p);
+	}
+	makeReady(p);
+}
+
+/************************************************************************
+ * preempts - Returns TRUE if a newly readied process should take the CPU 
+ *            from the Current Process cur.
+ *
+ *   - EDF beats MLFQ, and an earlier deadline beats a later one.
+ *   - Between MLFQ processes, a higher level beats a lower one.
+ ************************************************************************/
+int preempts(pcb_PTR p, pcb_PTR cur) {
+	if (p->p_period != 0 && p->p_remaining > 0) {
+		return (cur->p_period == 0) || ((p->p_deadline - cur->p_deadline) < 0);
+	}
+	if (cur->p_period != 0) {
+		return FALSE;
+	}
+	return p->p_level < cur->p_level;
+}
+
+/************************************************************************
+ * loadSlice - Loads the PLT for a process about to be dispatched.
+ *
+ *   - The slice is its remaining budget (EDF) or its quantum (MLFQ), 
+ *     cut short to the next EDF release if that comes first.
+ ************************************************************************/
+HIDDEN void loadSlice(pcb_PTR p, cpu_t now) {
+	cpu_t slice;
+	cpu_t untilRelease;
+
+	slice = (p->p_period != 0) ? p->p_remaining : quantumOf(p);
+	sliceCut = FALSE;
+	if (!emptyProcQ(edfSleep)) {
+		untilRelease = nextRelease() - now;
+		if (untilRelease < slice) {
+			slice = untilRelease;
+			sliceCut = TRUE;
+		}
+	}
+	p->p_sliceStart = p->p_time;
+	setTIMER(slice);
+}
+
+/************************************************************************
+ * boostReadyQueues - Moves every ready process, and the Current Process,
+ *                    back to level 0 (anti-starvation boost).
+ ************************************************************************/
+void boostReadyQueues() {
+	int level;
+
+	for (level = MLFQTOP + 1; level < MLFQLEVELS; level++) {
+		makeReadyAll(readyQueues[level]);
+		readyQueues[level] = mkEmptyProcQ();
+	}
+	readyMap &= (1 << MLFQTOP);
+	if (currentProcess != NULL) {
+		currentProcess->p_level = MLFQTOP;
+	}
+}
+
+/************************************************************************
+ * switchProcess - Implements the preemptive EDF + MLFQ scheduling algorithm.
+ *
+ *   - Releases the EDF jobs that are due, and boosts every MLFQ process 
+ *     to level 0 if MLFQBOOSTINTERVAL has passed since the last boost.
+ *   - Removes the ready EDF process with the earliest deadline, or else 
+ *     the PCB with the smallest pass from the highest-priority non-empty 
+ *     Ready Queue (recording that level in its p_level).
+ *   - Loads its slice on the processor’s Local Timer (PLT) and notes the 
+ *     start of its burst.
  *   - Calls loadProcessorState() to perform an LDST.
- *   - If the Ready Queue is empty:
- *     - If Process Count == 0, calls HALT().
- *     - If Process Count > 0 and Soft-block Count > 0, enters Wait State.
+ *   - If every Ready Queue is empty:
+ *     - If Process Count == 0, calls dumpSysProfile() and HALT().
+ *     - If Process Count > 0 and Soft-block Count > 0, enters Wait State 
+ *       (with the PLT set to wake it for the next EDF release, if any).
  *     - If Process Count > 0 and Soft-block Count == 0, calls PANIC().
  ************************************************************************/
 void switchProcess() {
-currentProcess = removeProcQ(&readyQueue);
-	if (currentProcess != NULL) {
-		setTIMER(INITIALPLT);  /* Load five milliseconds on the PLT */
+	int level;
+	cpu_t now;
+
+	STCKTICKS(now);
+	releaseJobs(now);
+	if ((now - lastBoost) >= boostInterval) {
+		lastBoost = now;
+		boostReadyQueues();  /* Anti-starvation: every process back to the top level */
+	}
+
+	if (!emptyProcQ(edfReady)) {
+		currentProcess = outProcQ(&edfReady, minDeadline());
+		loadSlice(currentProcess, now);  /* Load its budget (or the time to the next release) on the PLT */
+		loadProcessorState(currentProcess);  /* Load process state for execution */
+	}
+
+	if (readyMap != ALLOFF) {
+		level = firstLevel[readyMap];
+		currentProcess = outProcQ(&readyQueues[level], minPass(readyQueues[level]));
+		globalPass = currentProcess->p_pass;
+		if (emptyProcQ(readyQueues[level])) {
+			readyMap &= ~(1 << level);
+		}
+		currentProcess->p_level = level;
+		loadSlice(currentProcess, now);  /* Load the process's quantum on the PLT */
 		loadProcessorState(currentProcess);  /* Load process state for execution */
 	}
+	currentProcess = NULL;
 
-	/* Ready Queue is empty */
+	/* Every Ready Queue is empty */
 	if (processCount == INITPROCCOUNT) {
+		dumpSysProfile();  /* Print the SYSCALL profile on the printer */
 		HALT();  /* Halt system if no active processes */
 	}
 
 	/* The processor is not executing instructions, but waiting for a device interrupt to occur */
 	if ((processCount > INITPROCCOUNT) && (softBlockedCount > INITSOFTBLKCOUNT)) {
-		setSTATUS(ALLOFF | PANDOS_CAUSEINTMASK | IECON); /* Enable interrupts for the Status register so we can execute the WAIT instruction */
-		setTIMER(NEVER);  /* Set a high timer value to wait for device interrupt */
+		if (!emptyProcQ(edfSleep)) {
+			setSTATUS(ALLOFF | PANDOS_CAUSEINTMASK | IECON | TEBITON); /* Also let the PLT wake us for the next EDF release */
+			setTIMER(nextRelease() - now);
+		} else {
+			setSTATUS(ALLOFF | PANDOS_CAUSEINTMASK | IECON); /* Enable interrupts for the Status register so we can execute the WAIT instruction */
+			setTIMER(NEVER);  /* Set a high timer value to wait for device interrupt */
+		}
+		TRACEEVENT(TRIDLE, 0, 0);
 		WAIT();  /* Enter wait state */
 	}
 
@@ -0,0 +1,118 @@
+/******************************** slab.c **********************************
+ *
+ * This module implements the Slab Allocator used for nucleus and 
+ * support-level objects (PCBs, semaphore descriptors, delay descriptors).
+ *
+ *   - The frames between the end of the kernel and the stack frames at 
+ *     the top of RAM are handed out one at a time by allocFrame(), in 
+ *     address order (the pager takes its Swap Pool from here at boot).
+ *   - Each object cache (slabcache_t) keeps a free list of equally-sized 
+ *     objects. When a cache runs dry, slabAlloc() takes another frame and 
+ *     carves it into as many objects as fit, so caches start empty and grow 
+ *     on demand instead of being sized at compile time.
+ *   - Frames are never returned; freed objects go back on their cache's 
+ *     free list and are reused by the next slabAlloc() on that cache.
+ *   - A free object's first word is used as the free list link.
+ *
+ * The nucleus runs with interrupts disabled; support-level callers must 
+ * disable interrupts around slabAlloc()/slabFree() since the frame pointer 
+ * is shared with the nucleus.
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#include "../h/types.h"
+#include "../h/const.h"
+#include "../h/slab.h"
+
+HIDDEN memaddr nextFrame;   /* Address of the next unused frame */
+HIDDEN memaddr lastFrame;   /* First address past the region owned by the allocator */
+
+
+/************************************************************************
+ * initSlab - Hands the frames in [base, top) to the allocator.
+ *
+ *   - base is rounded up and top rounded down to a frame boundary.
+ *   - Called once by main() before any cache is used.
+ ************************************************************************/
+void initSlab(memaddr base, memaddr top) {
+	nextFrame = (base + PAGESIZE - 1) & ~(PAGESIZE - 1);
+	lastFrame = top & ~(PAGESIZE - 1);
+}
+
+/************************************************************************
+ * allocFrame - Returns the address of an unused frame, or 0 if every 
+ *              frame handed to initSlab() has been taken.
+ ************************************************************************/
+memaddr allocFrame() {
+	memaddr frame;
+
+	if (nextFrame >= lastFrame) {
+		return 0;
+	}
+	frame = nextFrame;
+	nextFrame += PAGESIZE;
+	return frame;
+}
+
+/************************************************************************
+ * framesLeft - Returns the number of frames allocFrame() can still hand 
+ *              out.
+ ************************************************************************/
+int framesLeft() {
+	if (nextFrame >= lastFrame) {
+		return 0;
+	}
+	return (lastFrame - nextFrame) / PAGESIZE;
+}
+
+/************************************************************************
+ * initCache - Initializes an empty cache of objSize-byte objects.
+ *
+ *   - objSize is rounded up so every object stays word-aligned and can 
+ *     hold the free list link.
+ ************************************************************************/
+void initCache(slabcache_t *cache, unsigned int objSize) {
+	if (objSize < sizeof(void *)) {
+		objSize = sizeof(void *);
+	}
+	cache->c_objSize = (objSize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	cache->c_free = NULL;
+	cache->c_frames = 0;
+}
+
+/************************************************************************
+ * slabAlloc - Removes an object from the cache and returns it.
+ *
+ *   - Grows the cache by one frame if its free list is empty.
+ *   - Returns NULL if no frame is left (or the object exceeds a frame).
+ *   - The returned object's contents are unspecified.
+ ************************************************************************/
+void *slabAlloc(slabcache_t *cache) {
+	void *obj;
+	memaddr frame;
+	unsigned int offset;
+
+	if (cache->c_free == NULL) {
+		if (cache->c_objSize > PAGESIZE || (frame = allocFrame()) == 0) {
+			return NULL;
+		}
+		/* Carve the new frame into objects, keeping them in address order on the free list */
+		for (offset = (PAGESIZE / cache->c_objSize) * cache->c_objSize; offset > 0; offset -= cache->c_objSize) {
+			slabFree(cache, (void *) (frame + offset - cache->c_objSize));
+		}
+		cache->c_frames++;
+	}
+
+	obj = cache->c_free;
+	cache->c_free = *((void **) obj);
+	return obj;
+}
+
+/************************************************************************
+ * slabFree - Returns an object to the free list of its cache.
+ ************************************************************************/
+void slabFree(slabcache_t *cache, void *obj) {
+	*((void **) obj) = cache->c_free;
+	cache->c_free = obj;
+}
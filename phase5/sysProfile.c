@@ -0,0 +1,121 @@
+/******************************** sysProfile.c **********************************
+ *
+ * SYSCALL profile: for every SYSCALL number, the number of requests, 
+ * their total latency and a log2 histogram of their latencies, in TOD 
+ * ticks from the SYSCALL to the return to the caller.
+ *
+ *   - SYS1-8 and the other Nucleus services are measured in exceptions.c: 
+ *     fast-path requests when they resume, requests that gave up the CPU 
+ *     when their process is next dispatched (so SYS5 includes the I/O).
+ *   - SYS9-18 and the other Support Level services are measured in 
+ *     sysSupport.c, from entry to the Support Level to the LDST back to 
+ *     the U-proc; they include the Nucleus requests they make.
+ *   - switchProcess() prints the profile on printer SYSPROFPRINTER just 
+ *     before HALT, polling the device since nothing may block by then.
+ *     That is the last printer, which only the U-proc with ASID UPROCMAX 
+ *     also writes to (SYS11). Every U-proc has ended by then, so on a run 
+ *     with UPROCMAX U-procs the profile follows that U-proc's output on 
+ *     the printer without being interleaved with it.
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#include "../h/types.h"
+#include "../h/const.h"
+#include "../h/sysProfile.h"
+#include "/usr/include/umps3/umps/libumps.h"
+
+HIDDEN sysprof_t sysProfile[SYSPROFCNT];  /* profiles, indexed by SYSCALL number */
+
+/************************************************************************
+ * profileSys - Records one request of SYSCALL sysNum that took ticks.
+ *
+ *   The Support Level records with interrupts on, so they are masked 
+ *   while the profile is updated.
+ ************************************************************************/
+void profileSys(int sysNum, cpu_t ticks) {
+	unsigned int status;
+	unsigned int rest;
+	int bucket;
+
+	if (sysNum < 0 || sysNum >= SYSPROFCNT) {
+		return;
+	}
+	bucket = 0;
+	for (rest = ((unsigned int) ticks) >> 1; rest != 0 && bucket < SYSPROFBUCKETS - 1; rest >>= 1) {
+		bucket++;
+	}
+
+	status = getSTATUS();
+	setSTATUS(status & IECOFF);
+	sysProfile[sysNum].sp_count++;
+	sysProfile[sysNum].sp_time += ticks;
+	sysProfile[sysNum].sp_hist[bucket]++;
+	setSTATUS(status);
+}
+
+/* Prints one character on the profile printer, waiting for it */
+HIDDEN void printChar(char c) {
+	device_t *printer = &(((devregarea_t *) RAMBASEADDR)->devreg[((PRNTINT - OFFSET) * DEVPERINT) + SYSPROFPRINTER]);
+
+	printer->d_data0 = c;
+	printer->d_command = PRINTCHR;
+	while ((printer->d_status & TERMSTATUSMASK) == BUSY) {
+		;
+	}
+}
+
+HIDDEN void printStr(char *s) {
+	while (*s != EOS) {
+		printChar(*s++);
+	}
+}
+
+HIDDEN void printNum(unsigned int n) {
+	char digits[12];
+	int i = 0;
+
+	do {
+		digits[i++] = '0' + (n % 10);
+		n = n / 10;
+	} while (n > 0);
+	while (i > 0) {
+		printChar(digits[--i]);
+	}
+}
+
+/************************************************************************
+ * dumpSysProfile - Prints, for every SYSCALL that was requested, 
+ *                  "SYSn: <count> calls, <ticks> ticks" followed by one 
+ *                  "  <2^(k+1): <count>" line per non-empty bucket.
+ ************************************************************************/
+void dumpSysProfile() {
+	device_t *printer = &(((devregarea_t *) RAMBASEADDR)->devreg[((PRNTINT - OFFSET) * DEVPERINT) + SYSPROFPRINTER]);
+	int sysNum;
+	int bucket;
+
+	printStr("SYSCALL profile (latency in TOD ticks)\n");
+	for (sysNum = 0; sysNum < SYSPROFCNT; sysNum++) {
+		if (sysProfile[sysNum].sp_count == 0) {
+			continue;
+		}
+		printStr("SYS");
+		printNum(sysNum);
+		printStr(": ");
+		printNum(sysProfile[sysNum].sp_count);
+		printStr(" calls, ");
+		printNum(sysProfile[sysNum].sp_time);
+		printStr(" ticks\n");
+		for (bucket = 0; bucket < SYSPROFBUCKETS; bucket++) {
+			if (sysProfile[sysNum].sp_hist[bucket] == 0) {
+				continue;
+			}
+			printStr((bucket < SYSPROFBUCKETS - 1) ? "  <" : "  >=");
+			printNum((bucket < SYSPROFBUCKETS - 1) ? (2U << bucket) : (1U << bucket));
+			printStr(": ");
+			printNum(sysProfile[sysNum].sp_hist[bucket]);
+			printChar('\n');
+		}
+	}
+	printer->d_command = ACK;
+}
@@ -1,5 +1,5 @@
 /******************************** sysSupport.c **********************************
- * This file implements user-mode support-level system services (from SYS9–SYS13) 
+ * This file implements user-mode support-level system services (from SYS9–SYS13, SYS18, SYS21–SYS24) 
  * for processes that have been assigned a support structure.
  * 
  * Written by Rosalie Lee, Luka Bagashvili
@@ -14,13 +14,9 @@
 #include "../h/initProc.h"
 #include "../h/exceptions.h"
 #include "../h/delayDaemon.h"
+#include "../h/sysProfile.h"
 #include "/usr/include/umps3/umps/libumps.h"
 
-void debugSys(int a, int b, int c, int d) {
-    int i =0;
-    i++;
-}
-
 /************************************************************************
  * Helper Function
  * Ensure the length is valid, this should be in the range of 0 to 12(MAXSTRINGLEN).
@@ -31,14 +27,37 @@ HIDDEN void illegalCheck(int len) {
     }
 }
 
+/************************************************************************
+ * Helper Function
+ * Returns to the U-proc from the SYS9+ request saved in its Support 
+ * Structure sPtr, recording the time since the request entered the 
+ * Support Level in the SYSCALL profile.
+ ************************************************************************/
+void returnToUProc(support_t *sPtr) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
+    cpu_t now;
+
+    STCKTICKS(now);
+    profileSys(savedState->s_a0, now - sPtr->sup_sysStart);
+    LDST(savedState);
+}
+
 /************************************************************************
  * SYS9: a user-mode “wrapper” for the kernel-mode restricted SYS2 service.
- * Causes the executing U-proc to cease to exist.
+ * Causes the executing U-proc to cease to exist, returning its Swap Pool 
+ * frames to the free list first.
  ************************************************************************/
 void schizoUserProcTerminate(int *address) {
-    if (address != NULL) {
+    support_t *sPtr = (support_t *) SYSCALL(GETSUPPORTPTR, 0, 0, 0);
+
+    if (address != NULL && address != &swapPoolSemaphore) {
         mutex(address, FALSE);  /* Release the mutex if proceess was terminated before it had chance to release sema4 */
     }
+    if (address != &swapPoolSemaphore) {
+        mutex(&swapPoolSemaphore, TRUE);
+    }
+    releaseFrames(sPtr->sup_asid);
+    mutex(&swapPoolSemaphore, FALSE);
     SYSCALL(VERHOGEN, (unsigned int) &masterSemaphore, 0, 0); /* Perform a V for my grace */
     SYSCALL(TERMINATEPROCESS, 0, 0, 0); /* SYS2 */
 }
@@ -47,11 +66,66 @@ void schizoUserProcTerminate(int *address) {
  * SYS10: Causes the number of microseconds since the system was last 
  * booted/reset to be placed/returned in the U-proc’s v0 register.
  ************************************************************************/
-HIDDEN void getTOD(state_PTR savedState) {
+HIDDEN void getTOD(support_t *sPtr) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
     cpu_t currTOD; 
     STCK(currTOD); /* Store the current value on the Time of Day clock */
     savedState->s_v0 = currTOD; /* Place the current system time (since last booted) in v0 */
-    LDST(savedState);
+    returnToUProc(sPtr);
+}
+
+/************************************************************************
+ * SYS21: user-mode wrapper for the Nucleus GETPID service. Returns the
+ * U-proc’s PID in v0.
+ ************************************************************************/
+HIDDEN void getPid(support_t *sPtr) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
+    savedState->s_v0 = SYSCALL(GETPID, 0, 0, 0); /* Still running as this U-proc, so the Nucleus sees its PCB */
+    returnToUProc(sPtr);
+}
+
+/************************************************************************
+ * SYS22: user-mode wrapper for the Nucleus SETSHARES service, restricted 
+ * to the calling U-proc. Sets its tickets to a1 and returns the previous 
+ * count in v0 (FAIL if a1 is out of range).
+ ************************************************************************/
+HIDDEN void setCpuShares(support_t *sPtr, int tickets) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
+    savedState->s_v0 = SYSCALL(SETSHARES, 0, tickets, 0); /* PID 0: the U-proc itself */
+    returnToUProc(sPtr);
+}
+
+/************************************************************************
+ * SYS23/SYS24: user-mode wrappers for the Nucleus EDF services. SYS23 
+ * reserves a2 microseconds of CPU every a1 microseconds for the U-proc; 
+ * SYS24 ends its current job and waits for the next release. The v0 the 
+ * Nucleus returns is passed back to the U-proc.
+ ************************************************************************/
+HIDDEN void edfRequest(support_t *sPtr, int syscallNumber) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
+    savedState->s_v0 = SYSCALL(syscallNumber, savedState->s_a1, savedState->s_a2, 0);
+    returnToUProc(sPtr);
+}
+
+/************************************************************************
+ * SYS25: user-mode wrapper for the Nucleus GETINTSTATS service. The 
+ * Nucleus fills a copy on this stack (it must not take a TLB refill), 
+ * which is then copied to the U-proc’s intstat_t at a3. A buffer outside 
+ * kuseg terminates the U-proc. The v0 the Nucleus returns (OK or FAIL) 
+ * is passed back to the U-proc.
+ ************************************************************************/
+HIDDEN void getIntStats(support_t *sPtr, intstat_PTR dest) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
+    intstat_t stat;
+
+    if ((memaddr) dest < KUSEG) {
+        ph3programTrapHandler(); /* Terminate the process */
+    }
+    savedState->s_v0 = SYSCALL(GETINTSTATS, savedState->s_a1, savedState->s_a2, (unsigned int) &stat);
+    if (savedState->s_v0 == OK) {
+        *dest = stat;
+    }
+    returnToUProc(sPtr);
 }
 
 /************************************************************************
@@ -62,7 +136,8 @@ HIDDEN void getTOD(state_PTR savedState) {
  * If the write was successful, returns the number of characters transmitted in v0. 
  * Otherwise, returns the negative of the device’s status value in v0.
  ************************************************************************/
-HIDDEN void writePrinter(state_PTR savedState, char *virtAddr, int len, int dnum) {
+HIDDEN void writePrinter(support_t *sPtr, char *virtAddr, int len, int dnum) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
     int charNum = 0; /* The number of characters that will be returned in v0 */
     devregarea_t *reg = (devregarea_t *) RAMBASEADDR; /* Get register pointer of RAM base */
     device_t *printerdev = &(reg->devreg[((PRNTINT - DISKINT) * DEVPERINT) + dnum]); /* Get the printer device pointer from device register */
@@ -83,7 +158,7 @@ HIDDEN void writePrinter(state_PTR savedState, char *virtAddr, int len, int dnum
         if ((statusCode & TERMSTATUSMASK) != DEVREDY) {
             savedState->s_v0 = 0 - (status & TERMSTATUSMASK); /* Return negative error code */
             mutex(&(p3devSemaphore[((PRNTINT - OFFSET) * DEVPERINT) + dnum]), FALSE); /* Release mutual exclusion from the printer device semaphore */
-            LDST(savedState);
+            returnToUProc(sPtr);
         }
 
         /* If successfully transmitted, move to next character */
@@ -93,7 +168,7 @@ HIDDEN void writePrinter(state_PTR savedState, char *virtAddr, int len, int dnum
     }
     savedState->s_v0 = charNum; /* Number of characters successfully transmitted */
     mutex(&(p3devSemaphore[((PRNTINT - OFFSET) * DEVPERINT) + dnum]), FALSE); /* Release mutual exclusion from the printer device semaphore */
-    LDST(savedState);
+    returnToUProc(sPtr);
 }
 
 /************************************************************************ 
@@ -104,7 +179,8 @@ HIDDEN void writePrinter(state_PTR savedState, char *virtAddr, int len, int dnum
  * If the write was successful, returns the number of characters transmitted in v0. 
  * Otherwise, returns the negative of the device’s status value in v0.
  ************************************************************************/
-HIDDEN void writeTerminal(state_PTR savedState, char *virtAddr, int len, int dnum) {
+HIDDEN void writeTerminal(support_t *sPtr, char *virtAddr, int len, int dnum) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
     int charNum = 0; /* The number of characters that will be returned in v0 */
     devregarea_t *reg = (devregarea_t *) RAMBASEADDR; /* Get register pointer of RAM base */
     device_t *terminaldev = &(reg->devreg[(TERMINT - DISKINT) * DEVPERINT + dnum]); /* Get the terminal device pointer from device register */
@@ -124,7 +200,7 @@ HIDDEN void writeTerminal(state_PTR savedState, char *virtAddr, int len, int dnu
         if (statusCode != CHARTRANSMITTED) {
             savedState->s_v0 = 0 - statusCode; /* Return negative error code */
             mutex(&(p3devSemaphore[((TERMINT - OFFSET) * DEVPERINT) + dnum + DEVPERINT]), FALSE); /* Release mutual exclusion from the terminal device semaphore */
-            LDST(savedState);
+            returnToUProc(sPtr);
         }
 
         /* If write was successful, move to next character */
@@ -135,7 +211,7 @@ HIDDEN void writeTerminal(state_PTR savedState, char *virtAddr, int len, int dnu
 
     savedState->s_v0 = charNum; /* Return number of characters successfully transmitted */
     mutex(&(p3devSemaphore[((TERMINT - OFFSET) * DEVPERINT) + dnum + DEVPERINT]), FALSE); /* Release mutual exclusion from the terminal device semaphore */
-    LDST(savedState);
+    returnToUProc(sPtr);
 }
 
 /************************************************************************
@@ -146,7 +222,8 @@ HIDDEN void writeTerminal(state_PTR savedState, char *virtAddr, int len, int dnu
  * If the read was successful, returns the number of characters transmitted in v0. 
  * Otherwise, returns the negative of the device’s status value in v0.
  ************************************************************************/
-HIDDEN void readTerminal(state_PTR savedState, char *virtAddr, int dnum) {
+HIDDEN void readTerminal(support_t *sPtr, char *virtAddr, int dnum) {
+    state_PTR savedState = &(sPtr->sup_exceptState[GENERALEXCEPT]);
     int charNum = 0; /* The number of characters that will be returned in v0 */
     devregarea_t *reg = (devregarea_t *) RAMBASEADDR; /* Get register pointer of RAM base */
     device_t *terminaldev = &(reg->devreg[(TERMINT - DISKINT) * DEVPERINT + dnum]); /* Get the terminal device pointer from device register */
@@ -165,7 +242,7 @@ HIDDEN void readTerminal(state_PTR savedState, char *virtAddr, int dnum) {
         if (statusCode != CHARRECIVED) {
             savedState->s_v0 = 0 - statusCode; /* Return negative error code */
             mutex(&(p3devSemaphore[((TERMINT - OFFSET) * DEVPERINT) + dnum]), FALSE); /* Release mutual exclusion from the terminal device semaphore */
-            LDST(savedState);
+            returnToUProc(sPtr);
         }
 
         /* If the read was successful, etrieve received character */
@@ -182,7 +259,7 @@ HIDDEN void readTerminal(state_PTR savedState, char *virtAddr, int dnum) {
 
     savedState->s_v0 = charNum; /* Number of characters received */
     mutex(&(p3devSemaphore[((TERMINT - OFFSET) * DEVPERINT) + dnum]), FALSE); /* Release mutual exclusion from the terminal device semaphore */
-    LDST(savedState);
+    returnToUProc(sPtr);
 }
 
 /************************************************************************
@@ -197,29 +274,29 @@ void supLvlGenExceptionHandler() {
     support_t *sPtr = (support_t *) SYSCALL(GETSUPPORTPTR, 0, 0, 0);
     state_PTR savedState = &(sPtr->sup_exceptState[1]);
 
+    STCKTICKS(sPtr->sup_sysStart); /* SYSCALL profile: the request starts here */
     unsigned int cause    = savedState->s_cause;
     unsigned int exc_code = (cause & PANDOS_CAUSEMASK) >> EXCCODESHIFT;
     int dnum = sPtr->sup_asid - 1; /* Each U-proc is associated with its own flash and terminal device. The ASID uniquely identifies the process and by extension, its devices*/
-    debugSys(3, exc_code, savedState->s_a0, 0);
-    if (exc_code != SYSCALLEXCPT) /* TLB-Modification Exception */
+    if (exc_code != SYSCALLEXCPT) /* Program Trap */
     {
-        ph3programTrapHandler(); /* Handle the TLB modification exception by invoking the program trap handler */
+        ph3programTrapHandler(); /* Terminate the U-proc */
     }
     int syscallNumber = savedState->s_a0; /* Extract Syscall number to handle other general exceptions */
-    debugSys(4, savedState->s_a1, syscallNumber, 0xBEEF);
 
     switch (syscallNumber) {
         case TERMINATE:            /* SYS9 */
+            profileSys(TERMINATE, 0); /* never returns: counted, with no latency */
             schizoUserProcTerminate(NULL); /* Terminate the current process */
             break;
 
         case GETTOD:               /* SYS10 */
-            getTOD(savedState); /* Get the current time of day */
+            getTOD(sPtr); /* Get the current time of day */
             break;
 
         case WRITEPRINTER:         /* SYS11 */
             writePrinter(
-                savedState,
+                sPtr,
                 (char *) (savedState->s_a1), /* virtual address of the string to print */
                 (int) (savedState->s_a2)    /* length of the string */
                 , dnum
@@ -228,7 +305,7 @@ void supLvlGenExceptionHandler() {
 
         case WRITETERMINAL:        /* SYS12 */
             writeTerminal(
-                savedState,
+                sPtr,
                 (char *) (savedState->s_a1), /* virtual address of the string to print */
                 (int) (savedState->s_a2)    /* length of the string */
                 , dnum
@@ -237,7 +314,7 @@ void supLvlGenExceptionHandler() {
 
         case READTERMINAL:         /* SYS13 */
             readTerminal(
-                savedState,
+                sPtr,
                 (char *) (savedState->s_a1) /* virtual address of the buffer to store the read characters */
                 , dnum
             ); 
@@ -249,6 +326,23 @@ void supLvlGenExceptionHandler() {
                 (int) (savedState->s_a1) /* number of seconds to delay */
             );
             break;
+
+        case GETPID:               /* SYS21 */
+            getPid(sPtr);
+            break;
+
+        case SETSHARES:            /* SYS22 */
+            setCpuShares(sPtr, (int) (savedState->s_a1) /* number of tickets */);
+            break;
+
+        case SETPERIOD:            /* SYS23 */
+        case WAITPERIOD:           /* SYS24 */
+            edfRequest(sPtr, syscallNumber);
+            break;
+
+        case GETINTSTATS:          /* SYS25 */
+            getIntStats(sPtr, (intstat_PTR) (savedState->s_a3) /* virtual address of the user's intstat_t */);
+            break;
         
         default:
             /* Should never enter if the syscallexc checks out */
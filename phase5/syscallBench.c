@@ -0,0 +1,118 @@
+/******************************** syscallBench.c **********************************
+ *
+ * Benchmark for the nucleus SYSCALL round trip. Linked in place of
+ * initProc.o (make syscallBench.core.umps) and booted with that core file.
+ *
+ * test() times BENCHITERS back-to-back calls of each non-blocking SYSCALL
+ * (SYS3/SYS4 as a non-blocking P/V pair, SYS6, SYS8, SYS21) with
+ * interrupts disabled, so neither the PLT nor devices get in the way, and
+ * prints the total time per SYSCALL on Terminal 0. With BENCHITERS at 1000
+ * the number of microseconds printed is also the round trip in
+ * nanoseconds. Finally test() terminates and the nucleus HALTs.
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "/usr/include/umps3/umps/libumps.h"
+
+#define BENCHITERS      1000        /* calls timed per SYSCALL */
+#define TERM0ADDR       0x10000254
+#define BYTELEN         8
+#define TERMSTATMASK    0xFF
+#define DECIMAL         10
+#define NUMLEN          12          /* enough digits for any unsigned int */
+
+/* Globals required by the Support Level modules linked into this kernel */
+int p3devSemaphore[PERIPHDEVCNT];
+int masterSemaphore;
+
+HIDDEN int term_mut = 1;        /* mutual exclusion on terminal 0 */
+HIDDEN int benchSem = 0;        /* P'ed and V'ed in pairs, never blocks */
+
+
+/* a procedure to print on terminal 0 */
+HIDDEN void print(char *msg) {
+	char *s = msg;
+	device_t *term0 = (device_t *) TERM0ADDR;
+	unsigned int status;
+
+	SYSCALL(PASSEREN, (unsigned int) &term_mut, 0, 0);
+	while (*s != EOS) {
+		term0->t_transm_command = TRANSMITCHAR | (((unsigned int) *s) << BYTELEN);
+		status = SYSCALL(WAITIO, TERMINT, 0, FALSE);
+		if ((status & TERMSTATMASK) != CHARTRANSMITTED) {
+			PANIC();
+		}
+		s++;
+	}
+	SYSCALL(VERHOGEN, (unsigned int) &term_mut, 0, 0);
+}
+
+/* print name, then n in decimal, then " us\n" */
+HIDDEN void printResult(char *name, unsigned int n) {
+	char digits[NUMLEN + 1];
+	int i = NUMLEN;
+
+	digits[i] = EOS;
+	do {
+		digits[--i] = '0' + (n % DECIMAL);
+		n = n / DECIMAL;
+	} while (n > 0);
+
+	print(name);
+	print(&digits[i]);
+	print(" us\n");
+}
+
+void test() {
+	cpu_t start, end;
+	unsigned int tPV, tCpu, tSup, tPid;
+	int i;
+
+	print("syscallBench: 1000 calls each, interrupts off\n");
+
+	setSTATUS(getSTATUS() & IECOFF);
+
+	STCK(start);
+	for (i = 0; i < BENCHITERS; i++) {
+		SYSCALL(VERHOGEN, (unsigned int) &benchSem, 0, 0);
+		SYSCALL(PASSEREN, (unsigned int) &benchSem, 0, 0);
+	}
+	STCK(end);
+	tPV = end - start;
+
+	STCK(start);
+	for (i = 0; i < BENCHITERS; i++) {
+		SYSCALL(GETCPUTIME, 0, 0, 0);
+	}
+	STCK(end);
+	tCpu = end - start;
+
+	STCK(start);
+	for (i = 0; i < BENCHITERS; i++) {
+		SYSCALL(GETSUPPORTPTR, 0, 0, 0);
+	}
+	STCK(end);
+	tSup = end - start;
+
+	STCK(start);
+	for (i = 0; i < BENCHITERS; i++) {
+		SYSCALL(GETPID, 0, 0, 0);
+	}
+	STCK(end);
+	tPid = end - start;
+
+	setSTATUS(getSTATUS() | IECON);
+
+	printResult("SYS4+SYS3 pair: ", tPV);
+	printResult("SYS6 GETCPUTIME: ", tCpu);
+	printResult("SYS8 GETSUPPORTPTR: ", tSup);
+	printResult("SYS21 GETPID: ", tPid);
+
+	/* processCount drops to zero: the nucleus should HALT */
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+	print("syscallBench error: SYS2 returned\n");
+	PANIC();
+}
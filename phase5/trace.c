@@ -0,0 +1,60 @@
+/******************************** trace.c **********************************
+ *
+ * Kernel flight recorder: a fixed-size ring of timestamped binary events 
+ * in RAM, recorded through TRACEEVENT() (see ../h/trace.h):
+ *   - dispatch, block and unblock of a process, the Wait State;
+ *   - SYSCALL entry, and the return from a fast-path SYSCALL;
+ *   - every timer and device interrupt handled;
+ *   - Support Level page faults, hard and soft.
+ *
+ * Only built with KTRACE defined (make KTRACE=1); otherwise this module is 
+ * empty and every TRACEEVENT() compiles to nothing. Once the ring is full 
+ * the oldest events are overwritten. The ring is headed by TRACEMAGIC and 
+ * its complement so host/ktrace can find it in a RAM image and turn it 
+ * into a Chrome trace.
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#include "../h/types.h"
+#include "../h/const.h"
+#include "../h/trace.h"
+#include "/usr/include/umps3/umps/libumps.h"
+
+#ifdef KTRACE
+
+tracebuf_t traceBuf;	/* the ring; global so it shows up in the kernel's symbol table */
+
+/************************************************************************
+ * traceInit - Writes the ring's header. Called once, at boot.
+ ************************************************************************/
+void traceInit() {
+	traceBuf.tb_magic = TRACEMAGIC;
+	traceBuf.tb_check = ~TRACEMAGIC;
+	traceBuf.tb_size = TRACESIZE;
+	traceBuf.tb_scale = TIMESCALE;
+	traceBuf.tb_next = 0;
+}
+
+/************************************************************************
+ * traceEvent - Appends one event to the ring.
+ *
+ *   The Support Level records with interrupts on, so they are masked 
+ *   while the slot is claimed and filled.
+ ************************************************************************/
+void traceEvent(unsigned int type, int pid, unsigned int arg) {
+	unsigned int status;
+	traceev_t *ev;
+
+	status = getSTATUS();
+	setSTATUS(status & IECOFF);
+	ev = &traceBuf.tb_ev[traceBuf.tb_next & (TRACESIZE - 1)];
+	STCKTICKS(ev->te_time);
+	ev->te_type = type;
+	ev->te_pid = pid;
+	ev->te_arg = arg;
+	traceBuf.tb_next++;
+	setSTATUS(status);
+}
+
+#endif
@@ -0,0 +1,158 @@
+/******************************** treeStress.c **********************************
+ *
+ * Stress test for SYS2 on a large process tree. Linked in place of
+ * initProc.o (make treeStress.core.umps) and booted with that core file.
+ *
+ *   1. test() grows a tree of TREESIZE kernel-mode processes below itself:
+ *      the first TREEDEPTH processes form a single chain (so the tree is
+ *      deep), and every process after that spawns up to TREEFANOUT children
+ *      (so it is also bushy).
+ *   2. Each node then either blocks on a plain semaphore, blocks on the
+ *      pseudo-clock, or spins on the Ready Queue, so SYS2 has to take PCBs
+ *      off the ASL, the device semaphores and the Ready Queue.
+ *   3. Once every node exists, test() issues SYS2 on itself, killing the
+ *      whole tree in one call. With processCount back at zero the nucleus
+ *      HALTs; a nucleus stack overflow or bookkeeping error shows up as a
+ *      PANIC or a hang instead.
+ *
+ * Node stacks are NODESTACK bytes each, carved out of frames taken from the
+ * slab allocator, so the RAM size in the uMPS3 machine configuration must
+ * leave about (TREESIZE * (sizeof(pcb_t) + NODESTACK)) bytes above the
+ * kernel; 256 RAM frames is enough.
+ *
+ * Produces progress messages on Terminal 0.
+ *
+ *  Written by Luka Bagashvili, Rosalie Lee
+ **************************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/slab.h"
+#include "/usr/include/umps3/umps/libumps.h"
+
+#define TREESIZE        1000        /* processes in the tree, not counting test() */
+#define TREEDEPTH       500         /* length of the initial chain */
+#define TREEFANOUT      3           /* children per process once the chain is built */
+#define NODESTACK       128         /* bytes of stack per tree process */
+#define TERM0ADDR       0x10000254
+#define BYTELEN         8
+#define TERMSTATMASK    0xFF
+
+/* Globals required by the Support Level modules linked into this kernel */
+int p3devSemaphore[PERIPHDEVCNT];
+int masterSemaphore;
+
+HIDDEN int term_mut = 1;        /* mutual exclusion on terminal 0 */
+HIDDEN int treeBuilt = 0;       /* V'ed once the last node has been created */
+HIDDEN int nodeSem = 0;         /* plain semaphore every third node blocks on */
+HIDDEN int created = 0;         /* nodes created so far */
+HIDDEN memaddr stackFrame = 0;  /* frame currently being carved into node stacks */
+HIDDEN memaddr stackNext = 0;   /* next unused stack top within stackFrame */
+HIDDEN state_t nodeState;       /* template state for every tree node */
+
+void treeNode();
+
+
+/* a procedure to print on terminal 0 */
+HIDDEN void print(char *msg) {
+	char *s = msg;
+	device_t *term0 = (device_t *) TERM0ADDR;
+	unsigned int status;
+
+	SYSCALL(PASSEREN, (unsigned int) &term_mut, 0, 0);
+	while (*s != EOS) {
+		term0->t_transm_command = TRANSMITCHAR | (((unsigned int) *s) << BYTELEN);
+		status = SYSCALL(WAITIO, TERMINT, 0, FALSE);
+		if ((status & TERMSTATMASK) != CHARTRANSMITTED) {
+			PANIC();
+		}
+		s++;
+	}
+	SYSCALL(VERHOGEN, (unsigned int) &term_mut, 0, 0);
+}
+
+/************************************************************************
+ * spawnNode - Creates one more tree node as a child of the caller.
+ *
+ *   Must be called with interrupts disabled: created, the stack carving
+ *   pointers and nodeState are shared by every node.
+ *   Returns FALSE once TREESIZE nodes exist (or no stack/PCB is left).
+ ************************************************************************/
+HIDDEN int spawnNode() {
+	if (created >= TREESIZE) {
+		return FALSE;
+	}
+	if (stackNext <= stackFrame) {
+		if ((stackFrame = allocFrame()) == 0) {
+			PANIC();	/* not enough RAM configured for the tree */
+		}
+		stackNext = stackFrame + PAGESIZE;
+	}
+	nodeState.s_sp = stackNext;
+	stackNext -= NODESTACK;
+
+	if (SYSCALL(CREATEPROCESS, (unsigned int) &nodeState, (unsigned int) NULL, 0) != OK) {
+		PANIC();	/* not enough RAM configured for the tree */
+	}
+	created++;
+	if (created == TREESIZE) {
+		SYSCALL(VERHOGEN, (unsigned int) &treeBuilt, 0, 0);
+	}
+	return TRUE;
+}
+
+/************************************************************************
+ * treeNode - Body of every process in the tree.
+ ************************************************************************/
+void treeNode() {
+	int myNumber;
+	int k;
+
+	setSTATUS(getSTATUS() & IECOFF);
+	myNumber = created;
+	if (myNumber < TREEDEPTH) {
+		spawnNode();
+	} else {
+		for (k = 0; k < TREEFANOUT && spawnNode(); k++) {
+			;
+		}
+	}
+	setSTATUS(getSTATUS() | IECON);
+
+	/* Park where SYS2 will have to find it */
+	switch (myNumber % 3) {
+		case 0:
+			SYSCALL(PASSEREN, (unsigned int) &nodeSem, 0, 0);
+			break;
+		case 1:
+			while (TRUE) {
+				SYSCALL(WAITCLOCK, 0, 0, 0);
+			}
+		default:
+			break;
+	}
+	while (TRUE) {
+		;
+	}
+}
+
+void test() {
+	nodeState.s_pc = (memaddr) treeNode;
+	nodeState.s_t9 = (memaddr) treeNode;
+	nodeState.s_status = ALLOFF | PANDOS_IEPBITON | TEBITON | PANDOS_CAUSEINTMASK;
+	nodeState.s_entryHI = ALLOFF;
+
+	print("treeStress: building process tree\n");
+
+	setSTATUS(getSTATUS() & IECOFF);
+	spawnNode();
+	setSTATUS(getSTATUS() | IECON);
+
+	SYSCALL(PASSEREN, (unsigned int) &treeBuilt, 0, 0);
+	print("treeStress: 1000 processes created, terminating the tree with one SYS2\n");
+
+	/* processCount drops to zero: the nucleus should HALT */
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+	print("treeStress error: SYS2 returned\n");
+	PANIC();
+}
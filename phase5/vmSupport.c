@@ -3,6 +3,34 @@
  * On page faults (TLB invalid), it either replace an existing occupant to flash 
  * or loads a new page in from flash. 
  * Also updates the TLB entries and page table entries for user-mode virtual memory.
+ *
+ * Victims are chosen by the clock (second-chance) algorithm. A resident 
+ * page's VALID bit doubles as its reference bit: the clock hand clears it 
+ * (in the Page Table and the TLB) and passes on, and a page still invalid 
+ * when the hand comes back round is evicted. Touching a page whose bit was 
+ * cleared is a soft fault: the page is still in its frame, so the pager 
+ * only sets VALID again, with no flash I/O.
+ *
+ * Free frames are kept on a list and used before anything is evicted; a 
+ * terminating U-proc's frames go back on it (releaseFrames()).
+ *
+ * The Swap Pool is sized from the installed RAM: initSwapStructs() takes 
+ * every frame the slab allocator can spare (SLABRESERVE frames stay 
+ * behind), up to SWAPPOOLMAX frames, plus the frames holding the Swap 
+ * Pool table itself. If fewer than SWAPPOOLMIN frames are left, it 
+ * PANICs rather than take the reserve.
+ *
+ * swapPoolSemaphore guards only the Swap Pool table, never flash I/O. A 
+ * page fault claims its frame (marks it busy) inside a short critical 
+ * section, then writes the occupant back and reads the missing page with 
+ * the mutex released; only the flash device of the U-proc concerned is 
+ * held meanwhile, so faults of U-procs on different flash devices overlap. 
+ * The clock skips busy frames, and a U-proc whose page sits in a busy 
+ * frame (being written back) sleeps on frameWaitSem until the write ends.
+ *
+ * Pages are mapped clean (Dirty off). The first write to a page raises a 
+ * TLB-Modification exception, on which the pager sets Dirty; only dirty 
+ * victims are written back to flash, clean ones are simply dropped.
  * 
  * Written by Rosalie Lee, Luka Bagashvili
  **************************************************************************/
@@ -13,21 +41,73 @@
 #include "../h/types.h"
 #include "../h/sysSupport.h"
 #include "../h/initProc.h"
+#include "../h/trace.h"
+#include "../h/slab.h"
 #include "/usr/include/umps3/umps/libumps.h"
 
 /* Each swap_t structure can hold info about a frame, who owns it, and which page number it corresponds to. */
-HIDDEN swap_t swapPool[2 * UPROCMAX];  /* Swap Pool table */
+HIDDEN swap_t *swapPool;               /* Swap Pool table, poolSize entries */
+HIDDEN memaddr poolBase;               /* address of Swap Pool frame 0 */
+HIDDEN int poolSize;                   /* number of Swap Pool frames */
+HIDDEN int clockHand;                  /* next frame the clock examines */
+HIDDEN int freeHead;                   /* first free Swap Pool frame, -1 if none */
+HIDDEN int frameWaitSem;               /* U-procs waiting for a busy frame block here */
+HIDDEN int frameWaiters;               /* number of U-procs blocked on frameWaitSem */
 int swapPoolSemaphore;                /* Controls mutual exclusion over swapPool */
 
 /************************************************************************
  * Helper Function
  * Initialize both the Swap Pool table and accompanying semaphore.
+ * The pool's frames come from the slab allocator, back to back, so a 
+ * frame's number is its offset from poolBase.
  ************************************************************************/
 void initSwapStructs() {
     int i;
-    for (i = 0; i < 2 * UPROCMAX; i++) {
+    int avail = framesLeft() - SLABRESERVE; /* frames for the pool and its table */
+    int target = (avail > SWAPPOOLMAX) ? SWAPPOOLMAX : avail;
+    int tableFrames;
+
+    /* Never dip into the SLABRESERVE frames the nucleus needs for PCBs, semds and delay descriptors */
+    if (target < SWAPPOOLMIN) {
+        PANIC(); /* Not enough RAM configured for paging */
+    }
+    tableFrames = ((target * sizeof(swap_t)) + PAGESIZE - 1) / PAGESIZE;
+    if (target + tableFrames > avail) {
+        target = avail - tableFrames;
+        if (target < SWAPPOOLMIN) {
+            PANIC();
+        }
+    }
+
+    disableInterrupts(); /* The nucleus shares the slab allocator's frames */
+    swapPool = (swap_t *) allocFrame();
+    for (i = 1; i < tableFrames; i++) {
+        if (allocFrame() == 0) {
+            swapPool = NULL;
+        }
+    }
+    poolBase = allocFrame();
+    poolSize = 0;
+    if (poolBase != 0) {
+        for (poolSize = 1; poolSize < target && allocFrame() != 0; poolSize++) {
+            ;
+        }
+    }
+    enableInterrupts();
+    /* Each U-proc keeps at most one frame busy, so the clock always finds one that is not */
+    if (swapPool == NULL || poolSize <= UPROCMAX) {
+        PANIC(); /* Not enough RAM configured for paging */
+    }
+
+    for (i = 0; i < poolSize; i++) {
         swapPool[i].asid = -1; /* Mark as free */
+        swapPool[i].next = (i + 1 < poolSize) ? i + 1 : -1; /* Frame 0 is handed out first */
+        swapPool[i].busy = 0;
     }
+    freeHead = 0;
+    clockHand = 0;
+    frameWaitSem = 0;
+    frameWaiters = 0;
     swapPoolSemaphore = 1;
 }
 
@@ -101,14 +181,111 @@ static void performRW(int asid, int pageBlock, int frameAddr, unsigned int opera
     int status = flashDev->d_status;
     /* If the device final status is an error, terminate the process */
     if ((operation == WRITEBLK && status == WRITEERR) || (operation == READBLK  && status == READERR)) {
-        /* Release the swap pool semaphore so we don't deadlock */
-        schizoUserProcTerminate(&swapPoolSemaphore); 
+        schizoUserProcTerminate(NULL); /* Flash I/O runs without swapPoolSemaphore */
     }
 }
 
+/************************************************************************
+ * Helper Function
+ * Sleeps until some busy frame is released. Called, and returns, with 
+ * swapPoolSemaphore held; the caller looks at the Swap Pool again.
+ ************************************************************************/
+HIDDEN void waitFrame() {
+    frameWaiters++;
+    mutex(&swapPoolSemaphore, FALSE);
+    mutex(&frameWaitSem, TRUE);
+    mutex(&swapPoolSemaphore, TRUE);
+}
+
+/************************************************************************
+ * Helper Function
+ * Wakes every U-proc sleeping in waitFrame(). The caller holds 
+ * swapPoolSemaphore.
+ ************************************************************************/
+HIDDEN void wakeWaiters() {
+    while (frameWaiters > 0) {
+        frameWaiters--;
+        mutex(&frameWaitSem, FALSE);
+    }
+}
+
+/************************************************************************
+ * Helper Function
+ * Returns the Swap Pool frame still holding page pn of the U-proc with 
+ * support structure sPtr (its Page Table entry keeps the frame address 
+ * while VALID is off), or -1 if the page is not resident.
+ ************************************************************************/
+HIDDEN int residentFrame(support_t *sPtr, int pn) {
+    unsigned int frameAddr = sPtr->sup_privatePgTbl[pn].entryLO & PFNMASK;
+    int frameNo;
+
+    if (frameAddr < poolBase) {
+        return -1;
+    }
+    frameNo = (frameAddr - poolBase) / PAGESIZE;
+    if (frameNo >= poolSize || swapPool[frameNo].asid != sPtr->sup_asid || swapPool[frameNo].VPN != pn) {
+        return -1;
+    }
+    return frameNo;
+}
+
+/************************************************************************
+ * Helper Function
+ * The clock, used once no frame is free: returns the frame to evict. A 
+ * frame whose page was referenced since the hand last passed (VALID on) 
+ * loses its reference bit and is skipped; the first frame not referenced 
+ * is the victim. Busy frames are passed over untouched. Ends within two 
+ * sweeps of the Swap Pool.
+ ************************************************************************/
+HIDDEN int selectVictim() {
+    int frameNo;
+    pte_entry_t *pte;
+
+    while (TRUE) {
+        frameNo = clockHand;
+        clockHand = (clockHand + 1) % poolSize;
+        if (swapPool[frameNo].busy != 0) {
+            continue;
+        }
+        pte = swapPool[frameNo].pte;
+        if ((pte->entryLO & VALIDON) == ALLOFF) {
+            return frameNo;
+        }
+        updateTLBIfCached(pte->entryHI, &pte->entryLO, pte->entryLO & VALIDOFFTLB); /* Second chance */
+    }
+}
+
+/************************************************************************
+ * Helper Function
+ * Returns every Swap Pool frame of the terminating U-proc asid to the 
+ * free list, without writing anything back. A frame it left busy after a 
+ * flash error is unclaimed: if the occupant's write-back failed, the 
+ * occupant's page stays in it. Frames other U-procs have claimed are left 
+ * to them. The caller holds swapPoolSemaphore.
+ ************************************************************************/
+void releaseFrames(int asid) {
+    int i;
+    pte_entry_t *pte;
+
+    for (i = 0; i < poolSize; i++) {
+        if (swapPool[i].busy == asid) {
+            swapPool[i].busy = 0;
+        }
+        if (swapPool[i].asid == asid && swapPool[i].busy == 0) {
+            pte = swapPool[i].pte;
+            updateTLBIfCached(pte->entryHI, &pte->entryLO, pte->entryLO & VALIDOFFTLB);
+            swapPool[i].asid = -1;
+            swapPool[i].next = freeHead;
+            freeHead = i;
+        }
+    }
+    wakeWaiters();
+}
+
 /************************************************************************
  * TLB exception handler – the Pager: handles TLB Invalid exceptions 
- * (page fault) of user process.
+ * (page fault) and TLB-Modification exceptions (first write to a clean 
+ * page) of user process.
  ************************************************************************/
 void supLvlTlbExceptionHandler() {
     support_t *sPtr = (support_t *) SYSCALL(GETSUPPORTPTR, 0, 0, 0); /* Current process's support struct */
@@ -117,34 +294,86 @@ void supLvlTlbExceptionHandler() {
     unsigned int cause = savedState->s_cause;
     unsigned int exc_code = (cause & PANDOS_CAUSEMASK) >> EXCCODESHIFT;
 
+    unsigned int entryHI = savedState->s_entryHI;
+    int missingPN = ((entryHI & VPNMASK) >> VPNSHIFT) % PGTBLSIZE; /* Hash the page number from the VPN of the missing TLB entry */
+    pte_entry_t *missingPTE = &(sPtr->sup_privatePgTbl[missingPN]);
+
+    mutex(&swapPoolSemaphore, TRUE);
+
+    /* The page may be in a frame another U-proc is writing back: let that finish first */
+    int frameNo = residentFrame(sPtr, missingPN);
+    while (frameNo != -1 && swapPool[frameNo].busy != 0) {
+        waitFrame();
+        frameNo = residentFrame(sPtr, missingPN);
+    }
+
+    /* First write to a clean page: from now on its eviction writes it back */
     if (exc_code == TLBMODEXC) {
-        ph3programTrapHandler();
+        if (frameNo == -1) {
+            /* Evicted while we waited for the mutex: retry the store, it page-faults normally */
+            mutex(&swapPoolSemaphore, FALSE);
+            LDST(savedState);
+        }
+        updateTLBIfCached(missingPTE->entryHI, &missingPTE->entryLO, missingPTE->entryLO | VALIDON | DIRTYON);
+        mutex(&swapPoolSemaphore, FALSE);
+        LDST(savedState);
     }
-    mutex(&swapPoolSemaphore, TRUE);
 
-    unsigned int entryHI = savedState->s_entryHI;
-    int missingPN = ((entryHI & VPNMASK) >> VPNSHIFT) % PGTBLSIZE; /* Hash the page number from the VPN of the missing TLB entry */
+    /* Soft fault: the clock cleared the page's reference bit, but it is still resident */
+    if (frameNo != -1) {
+        TRACEEVENT(TRSOFTFAULT, SYSCALL(GETPID, 0, 0, 0), missingPN); /* SYS21 only runs in KTRACE builds */
+        updateTLBIfCached(missingPTE->entryHI, &missingPTE->entryLO, missingPTE->entryLO | VALIDON);
+        mutex(&swapPoolSemaphore, FALSE);
+        LDST(savedState);
+    }
+    TRACEEVENT(TRPAGEFAULT, SYSCALL(GETPID, 0, 0, 0), missingPN); /* SYS21 only runs in KTRACE builds */
+
+    if (freeHead != -1) {
+        frameNo = freeHead; /* No pressure: nothing to evict */
+        freeHead = swapPool[frameNo].next;
+    } else {
+        frameNo = selectVictim();
+    }
+
+    int frameAddr = poolBase + (frameNo * PAGESIZE);
+    int writeBack = FALSE;
 
-    static int frameNo;
-    frameNo = (frameNo + 1) % (2 * UPROCMAX);
+    /* Claim the frame: the clock skips it and the occupant's faults wait for it */
+    swapPool[frameNo].busy = sPtr->sup_asid;
 
-    int frameAddr = SWAPPOOLADDR + (frameNo * PAGESIZE);
+    /* occupant info */
+    int occupantAsid = swapPool[frameNo].asid;
+    int occupantVPN  = swapPool[frameNo].VPN;
 
-    if (swapPool[frameNo].asid != -1) {
-        /* occupant info */
-        int occupantAsid = swapPool[frameNo].asid;
-        int occupantVPN  = swapPool[frameNo].VPN;
+    if (occupantAsid != -1) {
         pte_entry_t *occPTEntry = swapPool[frameNo].pte;
 
         updateTLBIfCached(occPTEntry->entryHI, &occPTEntry->entryLO, occPTEntry->entryLO & VALIDOFFTLB);
+        writeBack = ((occPTEntry->entryLO & DIRTYON) != ALLOFF); /* unless flash already holds it */
+    }
+    if (!writeBack) {
+        swapPool[frameNo].asid = sPtr->sup_asid;
+        swapPool[frameNo].VPN  = missingPN;
+        swapPool[frameNo].pte  = missingPTE;
+    }
+    mutex(&swapPoolSemaphore, FALSE);
 
-        /* Write occupant’s page out */
+    /* Flash I/O happens outside the mutex, holding only the device concerned */
+    if (writeBack) {
         performRW(
             occupantAsid,       /* occupant process ID */
             occupantVPN,        /* occupant’s block number */
             frameAddr,          /* frame index in swap pool */
             WRITEBLK            /* operation = write */
         );
+
+        /* The occupant's page is safe on flash: its faults may read it back now */
+        mutex(&swapPoolSemaphore, TRUE);
+        swapPool[frameNo].asid = sPtr->sup_asid;
+        swapPool[frameNo].VPN  = missingPN;
+        swapPool[frameNo].pte  = missingPTE;
+        wakeWaiters();
+        mutex(&swapPoolSemaphore, FALSE);
     }
 
     performRW(
@@ -154,17 +383,13 @@ void supLvlTlbExceptionHandler() {
         READBLK           /* operation = read */
     );
 
-    swapPool[frameNo].asid = sPtr->sup_asid;
-    swapPool[frameNo].VPN  = missingPN;
-    swapPool[frameNo].pte  = &(sPtr->sup_privatePgTbl[missingPN]);
-
+    mutex(&swapPoolSemaphore, TRUE);
+    swapPool[frameNo].busy = 0;
     updateTLBIfCached(
-        sPtr->sup_privatePgTbl[missingPN].entryHI,
-        &sPtr->sup_privatePgTbl[missingPN].entryLO,
-        frameAddr | VALIDON | DIRTYON
+        missingPTE->entryHI,
+        &missingPTE->entryLO,
+        frameAddr | VALIDON     /* clean until its first write */
     );
-
-
     mutex(&swapPoolSemaphore, FALSE);
     LDST(savedState);
 }
@@ -187,8 +412,8 @@ void uTLB_RefillHandler() {
 }
 
 /************************************************************************
- * This function terminates the current user process if a TLB modification 
- * exception or other program trap occurs in user-mode.
+ * This function terminates the current user process if a program trap 
+ * occurs in user-mode.
  ************************************************************************/
 void ph3programTrapHandler() {
     schizoUserProcTerminate(NULL); 
@@ -0,0 +1,30 @@
+/*	Test that blocking P operations reach the SYSCALL profile: each
+ *	SYS18 (DELAY) blocks this U-proc in a SYS3 on its private delay
+ *	semaphore until the delay daemon wakes it. Run it with the profiling
+ *	kernel; the profile dumped at HALT must list SYS3 with at least
+ *	DELAYS calls of a second or more (buckets >= SECOND * TIMESCALE ticks). */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define DELAYS		3		/* blocking P operations to cause */
+
+void main() {
+	unsigned int before, after;
+	int i;
+
+	print(WRITETERMINAL, "contendedP starts\n");
+
+	for (i = 0; i < DELAYS; i++) {
+		before = SYSCALL(GET_TOD, 0, 0, 0);
+		SYSCALL(DELAY, 1, 0, 0);		/* blocks in SYS3 for a second */
+		after = SYSCALL(GET_TOD, 0, 0, 0);
+		if ((after - before) < SECOND)
+			print(WRITETERMINAL, "contendedP error: did not block for a second\n");
+	}
+
+	print(WRITETERMINAL, "contendedP completed: the SYSCALL profile must show SYS3 blocked 3 times for a second or more\n");
+
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
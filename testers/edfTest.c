@@ -0,0 +1,87 @@
+/*	Test of the EDF scheduling class (SYS23 SETPERIOD, SYS24 WAITPERIOD):
+ *	reserves BUDGET us of CPU every PERIOD us, runs ONTIMEJOBS short jobs
+ *	that should all meet their deadlines, then one job that overruns its
+ *	budget and must be reported as missing at least one deadline. */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define PERIOD		100000		/* 100 ms */
+#define BUDGET		20000		/* 20 ms of CPU per period */
+#define ONTIMEJOBS	20
+#define SHORTJOB	5000		/* a job well inside the budget */
+#define LONGJOB		(3 * BUDGET)	/* a job that needs three budgets */
+
+/* busy-wait for us microseconds of wall-clock time */
+void spin(unsigned int us) {
+	unsigned int start;
+
+	start = SYSCALL(GET_TOD, 0, 0, 0);
+	while ((SYSCALL(GET_TOD, 0, 0, 0) - start) < us)
+		;
+}
+
+/* print msg followed by n in decimal and a newline */
+void printNum(char *msg, int n) {
+	char buf[40];
+	char digits[12];
+	int i, j;
+
+	for (i = 0; msg[i] != EOS; i++)
+		buf[i] = msg[i];
+	j = 0;
+	do {
+		digits[j++] = '0' + (n % 10);
+		n = n / 10;
+	} while (n > 0);
+	while (j > 0)
+		buf[i++] = digits[--j];
+	buf[i++] = '\n';
+	buf[i] = EOS;
+	print(WRITETERMINAL, buf);
+}
+
+void main() {
+	int i, base, missed;
+
+	print(WRITETERMINAL, "edfTest starts\n");
+
+	if (SYSCALL(SETPERIOD, PERIOD, BUDGET, 0) != 0) {
+		print(WRITETERMINAL, "edfTest error: reservation refused\n");
+		SYSCALL(TERMINATE, 0, 0, 0);
+	}
+
+	/* a 100% reservation must fail the admission test (and keep the old one) */
+	if (SYSCALL(SETPERIOD, PERIOD, PERIOD, 0) == 0)
+		print(WRITETERMINAL, "edfTest error: 100% utilization admitted\n");
+	else
+		print(WRITETERMINAL, "edfTest ok: admission test refused 100%\n");
+
+	/* warm-up job: its page faults may well cost it its deadline */
+	spin(SHORTJOB);
+	base = SYSCALL(WAITPERIOD, 0, 0, 0);
+
+	for (i = 0; i < ONTIMEJOBS; i++) {
+		spin(SHORTJOB);
+		missed = SYSCALL(WAITPERIOD, 0, 0, 0) - base;
+	}
+	printNum("edfTest: deadlines missed by short jobs: ", missed);
+	if (missed != 0)
+		print(WRITETERMINAL, "edfTest error: short jobs missed deadlines\n");
+	else
+		print(WRITETERMINAL, "edfTest ok: short jobs met every deadline\n");
+
+	/* this job is throttled at least once, so its deadline must be missed */
+	spin(LONGJOB);
+	i = SYSCALL(WAITPERIOD, 0, 0, 0) - base;
+	printNum("edfTest: deadlines missed after the long job: ", i);
+	if (i <= missed)
+		print(WRITETERMINAL, "edfTest error: overrun not reported\n");
+	else
+		print(WRITETERMINAL, "edfTest ok: overrun reported as missed\n");
+
+	print(WRITETERMINAL, "edfTest completed\n");
+
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
@@ -31,6 +31,15 @@
 #define DELAY			18
 #define PSEMVIRT		19
 #define VSEMVIRT		20
+#define GETPID			21
+#define SETSHARES		22
+#define SETPERIOD		23
+#define WAITPERIOD		24
+#define GETINTSTATS		25
+
+/* SYS25 selectors */
+#define INTSTATLINE		0
+#define INTSTATDEVICE	1
 
 #define SEG0			0x00000000
 #define SEG1			0x40000000
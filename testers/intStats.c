@@ -0,0 +1,90 @@
+/*	Test of the interrupt statistics (SYS25 GETINTSTATS): causes some
+ *	terminal and pseudo-clock interrupts, then prints on the terminal the
+ *	count, total handler time and worst latency (TOD ticks) of every
+ *	interrupt line and of every device that has interrupted. */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define LINECNT		8		/* interrupt lines, indexed by line number */
+#define DEVCNT		49		/* device semaphores (the last is the pseudo-clock) */
+#define PCLOCKIDX	(DEVCNT - 1)
+
+/* one line's or one device's statistics, as filled in by SYS25 */
+typedef struct intstat_t {
+	unsigned int	is_count;
+	int				is_time;
+	int				is_maxLatency;
+} intstat_t;
+
+/* append n in decimal to buf at i; returns the new end */
+int putNum(char *buf, int i, unsigned int n) {
+	char digits[12];
+	int j;
+
+	j = 0;
+	do {
+		digits[j++] = '0' + (n % 10);
+		n = n / 10;
+	} while (n > 0);
+	while (j > 0)
+		buf[i++] = digits[--j];
+	return i;
+}
+
+/* append msg to buf at i; returns the new end */
+int putStr(char *buf, int i, char *msg) {
+	while (*msg != EOS)
+		buf[i++] = *msg++;
+	return i;
+}
+
+/* print "<name> <n>: count <c> ticks <t> max <m>" */
+void printStat(char *name, int n, intstat_t *stat) {
+	char buf[100];
+	int i;
+
+	i = putStr(buf, 0, name);
+	i = putNum(buf, i, n);
+	i = putStr(buf, i, ": count ");
+	i = putNum(buf, i, stat->is_count);
+	i = putStr(buf, i, " ticks ");
+	i = putNum(buf, i, stat->is_time);
+	i = putStr(buf, i, " max ");
+	i = putNum(buf, i, stat->is_maxLatency);
+	buf[i++] = '\n';
+	buf[i] = EOS;
+	print(WRITETERMINAL, buf);
+}
+
+void main() {
+	intstat_t stat;
+	int i;
+
+	print(WRITETERMINAL, "intStats starts\n");
+
+	/* some pseudo-clock interrupts, through the delay daemon */
+	SYSCALL(DELAY, 1, 0, 0);
+
+	if (SYSCALL(GETINTSTATS, INTSTATDEVICE, DEVCNT, (int) &stat) == 0)
+		print(WRITETERMINAL, "intStats error: bad device index accepted\n");
+
+	for (i = 1; i < LINECNT; i++) {
+		if (SYSCALL(GETINTSTATS, INTSTATLINE, i, (int) &stat) != 0)
+			print(WRITETERMINAL, "intStats error: line refused\n");
+		else
+			printStat("line ", i, &stat);
+	}
+
+	for (i = 0; i < DEVCNT; i++) {
+		if (SYSCALL(GETINTSTATS, INTSTATDEVICE, i, (int) &stat) != 0)
+			print(WRITETERMINAL, "intStats error: device refused\n");
+		else if (stat.is_count > 0)
+			printStat((i == PCLOCKIDX) ? "pseudo-clock " : "device ", i, &stat);
+	}
+
+	print(WRITETERMINAL, "intStats completed\n");
+
+	SYSCALL(TERMINATE, 0, 0, 0);
+}